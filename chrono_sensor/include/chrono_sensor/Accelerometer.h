@@ -43,6 +43,9 @@ class CH_VEHICLE_API Accelerometer : public ChSensor<ChVector<>> {
   std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> Get_DigitalTransform();
   std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> Get_NoiseTransform();
 
+ private:
+  std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> m_noise;
+  std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> m_digitize;
 };
 } /// sensor
 } /// vehicle
@@ -24,10 +24,12 @@
 #ifndef CHRONO_SENSOR_CHFUNCTION_SENSOR_H
 #define CHRONO_SENSOR_CHFUNCTION_SENSOR_H
 
+#include <cstddef>
 #include <typeinfo>
 
 #include "chrono/core/ChApiCE.h"
 #include "chrono/core/ChClassFactory.h"
+#include "chrono_sensor/ChSensorSnapshot.h"
 
 namespace chrono {
 namespace vehicle {
@@ -37,7 +39,13 @@ enum FunctionType {
   FUNCT_CUSTOM,
   FUNCT_NOISE,
   FUNCT_BIAS,
-  FUNCT_DIGITIZE
+  FUNCT_DIGITIZE,
+  FUNCT_RANDOM_WALK,
+  FUNCT_GAUSS_MARKOV,
+  FUNCT_FLICKER,
+  FUNCT_FILTER,
+  FUNCT_TABLE,
+  FUNCT_ORIENTATION_NOISE
 };
 
 template<typename T = double>
@@ -91,6 +99,29 @@ class ChApi ChFunction_Sensor {
     }
   };
 
+  /// Evaluate the function at n positions (x and y must not overlap). Derived classes may override this with a
+  /// vectorized version.
+  virtual void Get_y_Batch(const T *x, T *y, size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = Get_y(x[i]);
+    }
+  }
+
+  /// Evaluate dy/dx at n positions. Derived classes with a closed form derivative may override this
+  /// with a version that avoids the per-element virtual calls.
+  virtual void Get_y_dx_Batch(const T *x, T *dydx, size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+      dydx[i] = Get_y_dx(x[i]);
+    }
+  }
+
+  /// Evaluate ddy/dxdx at n positions.
+  virtual void Get_y_dxdx_Batch(const T *x, T *dydxdx, size_t n) const {
+    for (size_t i = 0; i < n; ++i) {
+      dydxdx[i] = Get_y_dxdx(x[i]);
+    }
+  }
+
   /// Return the weight of the function (useful for
   /// applications where you need to mix different weighted ChFunctions)
   virtual double Get_weight(T x) const { return 1.0; };
@@ -106,9 +137,21 @@ class ChApi ChFunction_Sensor {
     }
   }
 
-  /// Update could be implemented by children classes, ex. to launch callbacks
+  /// Update could be implemented by children classes, ex. to launch callbacks or to advance
+  /// an internal (stateful) process up to time x. Sensors call it before each Get_y() of a sample.
   virtual void Update(const double x) {}
 
+  /// Return true if the function needs the input of every simulation step (ex. anti-aliasing filters),
+  /// instead of only the input at the sample instants.
+  virtual bool Is_Streaming() const { return false; }
+
+  /// Feed a streaming function with the input of a simulation step.
+  virtual void Push(const T &x) {}
+
+  /// Output of a streaming function as it was the given number of pushes (at most 2) ago, so sensors only need to
+  /// evaluate it on the steps they sample.
+  virtual T Get_y_Delayed(const T &x, const size_t steps) const { return Get_y(x); }
+
   /// Method to allow serialization of transient data to archives
   virtual void ArchiveOUT(ChArchiveOut &marchive) {
     // version number
@@ -121,6 +164,12 @@ class ChApi ChFunction_Sensor {
     int version = marchive.VersionRead<ChFunction_Sensor<T>>();
   }
 
+  /// Write the complete state (parameters, internal state and random generator) to a binary snapshot.
+  virtual void SnapshotOut(ChSensorSnapshot &snapshot) const {}
+
+  /// Restore the state written by SnapshotOut(). Return false if the snapshot is exhausted.
+  virtual bool SnapshotIn(ChSensorSnapshot &snapshot) { return true; }
+
  private:
   ChQuaternion<> M_BSL;
 };
@@ -24,6 +24,8 @@
 #ifndef CHRONO_SENSOR_CHFUNCTION_SENSORBIAS_H
 #define CHRONO_SENSOR_CHFUNCTION_SENSORBIAS_H
 
+#include <algorithm>
+
 #include "chrono/core/ChVectorDynamic.h"
 #include "ChFunction_Sensor.h"
 
@@ -64,6 +66,59 @@ class ChApi ChFunction_SensorBias : public ChFunction_Sensor<T> {
     }
   }
 
+  /// The bias has a unit (element wise) slope. Quaternion biases use the numerical derivative.
+  T Get_y_dx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return ChFunction_Sensor<T>::Get_y_dx(x);
+    } else {
+      return T(1.);
+    }
+  }
+
+  T Get_y_dxdx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return ChFunction_Sensor<T>::Get_y_dxdx(x);
+    } else {
+      return T(0.);
+    }
+  }
+
+  void Get_y_dx_Batch(const T *x, T *dydx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      ChFunction_Sensor<T>::Get_y_dx_Batch(x, dydx, n);
+    } else {
+      std::fill(dydx, dydx + n, T(1.));
+    }
+  }
+
+  void Get_y_dxdx_Batch(const T *x, T *dydxdx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      ChFunction_Sensor<T>::Get_y_dxdx_Batch(x, dydxdx, n);
+    } else {
+      std::fill(dydxdx, dydxdx + n, T(0.));
+    }
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    snapshot.Write(m_bias);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return snapshot.Read(m_bias);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorBias<T>>();
+    ChFunction_Sensor<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_bias);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorBias<T>>();
+    ChFunction_Sensor<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_bias);
+  }
+
   T Get_Bias() const {
     return m_bias;
   }
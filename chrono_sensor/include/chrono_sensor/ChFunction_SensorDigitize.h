@@ -24,6 +24,7 @@
 #ifndef CHRONO_SENSOR_CHFUNCTION_SENSORDIGITIZE_H
 #define CHRONO_SENSOR_CHFUNCTION_SENSORDIGITIZE_H
 
+#include <algorithm>
 #include <array>
 
 #include "ChFunction_Sensor.h"
@@ -67,7 +68,10 @@ class ChApi ChFunction_SensorDigitize : public ChFunction_Sensor<T> {
     return FUNCT_DIGITIZE;
   }
 
+  /// Digitize x; zero bits disable the digitization.
   T Get_y(const T &x) const override {
+    if (m_bits == 0.)
+      return x;
     if constexpr(std::is_same<T, ChQuaternion<>>::value) {
       auto x_p = ChVector<>(x.e1(), x.e2(), x.e3());
       auto x_d_vec = ChVector<>(m_res * Round(x_p / m_res));
@@ -77,7 +81,66 @@ class ChApi ChFunction_SensorDigitize : public ChFunction_Sensor<T> {
     }
   }
 
-  opt_vect_t<T> &Get_Range() const {
+  /// The staircase is flat between the digitization steps, so the derivatives vanish almost everywhere (the
+  /// numerical derivative only differs where x + h crosses a step). Disabled digitizers have a unit slope.
+  T Get_y_dx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return ChFunction_Sensor<T>::Get_y_dx(x);
+    } else {
+      return T(m_bits == 0. ? 1. : 0.);
+    }
+  }
+
+  T Get_y_dxdx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return ChFunction_Sensor<T>::Get_y_dxdx(x);
+    } else {
+      return T(0.);
+    }
+  }
+
+  void Get_y_dx_Batch(const T *x, T *dydx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      ChFunction_Sensor<T>::Get_y_dx_Batch(x, dydx, n);
+    } else {
+      std::fill(dydx, dydx + n, T(m_bits == 0. ? 1. : 0.));
+    }
+  }
+
+  void Get_y_dxdx_Batch(const T *x, T *dydxdx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      ChFunction_Sensor<T>::Get_y_dxdx_Batch(x, dydxdx, n);
+    } else {
+      std::fill(dydxdx, dydxdx + n, T(0.));
+    }
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    snapshot.Write(m_range);
+    snapshot.Write(m_res);
+    snapshot.Write(m_bits);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return snapshot.Read(m_range) && snapshot.Read(m_res) && snapshot.Read(m_bits);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorDigitize<T>>();
+    ChFunction_Sensor<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_range);
+    marchive << CHNVP(m_bits);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorDigitize<T>>();
+    ChFunction_Sensor<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_range);
+    marchive >> CHNVP(m_bits);
+    m_res = Calc_Resolution(m_range, m_bits);
+  }
+
+  const opt_vect_t<T> &Get_Range() const {
     return m_range;
   }
 
@@ -86,6 +149,11 @@ class ChApi ChFunction_SensorDigitize : public ChFunction_Sensor<T> {
     m_res = Calc_Resolution(m_range, m_bits);
   }
 
+  /// Size of one count of the digitized output.
+  const opt_vect_t<T> &Get_Resolution() const {
+    return m_res;
+  }
+
   double Get_Bits() const {
     return m_bits;
   }
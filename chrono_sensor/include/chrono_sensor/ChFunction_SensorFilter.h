@@ -0,0 +1,199 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORFILTER_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORFILTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "chrono/core/ChMathematics.h"
+#include "ChFunction_Sensor.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// FIR anti-aliasing filter, run at the simulation step rate and decimated to the sensor sample rate.
+/// Push() only stores the step input in a mirrored ring buffer; the convolution is evaluated in Get_y(), so
+/// only the outputs that are actually sampled are computed (the polyphase form of a decimating FIR). The buffer
+/// keeps two inputs beyond the taps, so the outputs of the two previous steps can still be evaluated for the
+/// interpolation of oversampled sensors.
+/// Get_y() ignores its argument: the sensor pushes the output of the preceding stage on every step, so the filter
+/// may be placed anywhere in the transform chain.
+template<typename T = double>
+class ChApi ChFunction_SensorFilter : public ChFunction_Sensor<T> {
+ public:
+  ChFunction_SensorFilter() : m_pos(0), m_started(false) {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value,
+                  "ChFunction_SensorFilter requires a double or chrono::ChVector<double> type");
+    Set_Taps(std::vector<double>{1.});
+  };
+
+  explicit ChFunction_SensorFilter(const std::vector<double> &Taps) : m_pos(0), m_started(false) {
+    Set_Taps(Taps);
+  };
+
+  ChFunction_SensorFilter<T> *Clone() const override {
+    return new ChFunction_SensorFilter<T>(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_FILTER;
+  }
+
+  bool Is_Streaming() const override {
+    return true;
+  }
+
+  void Push(const T &x) override {
+    size_t n = m_taps.size() + HISTORY;
+    if (!m_started) {
+      // Start from a steady state instead of a zero history
+      for (size_t c = 0; c < DIM; ++c) {
+        std::fill(m_buffer.begin() + c * 2 * n, m_buffer.begin() + (c + 1) * 2 * n, Component(x, c));
+      }
+      m_started = true;
+    }
+    m_pos = m_pos + 1 == n ? 0 : m_pos + 1;
+    for (size_t c = 0; c < DIM; ++c) {
+      m_buffer[c * 2 * n + m_pos] = Component(x, c);
+      m_buffer[c * 2 * n + m_pos + n] = Component(x, c);
+    }
+  }
+
+  T Get_y(const T &x) const override {
+    return Get_y_Delayed(x, 0);
+  }
+
+  T Get_y_Delayed(const T &x, const size_t steps) const override {
+    size_t n = m_taps.size();
+    size_t m = n + HISTORY;
+    const double *taps = m_taps.data();
+    T y;
+    for (size_t c = 0; c < DIM; ++c) {
+      // Contiguous window, oldest to newest, ending at the input pushed the given number of steps ago
+      const double *window = m_buffer.data() + c * 2 * m + m_pos + 1 + HISTORY - std::min(steps, HISTORY);
+      double acc = 0.;
+#pragma omp simd reduction(+:acc)
+      for (size_t k = 0; k < n; ++k) {
+        acc += taps[k] * window[k];
+      }
+      Component(y, c) = acc;
+    }
+    return y;
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    snapshot.Write(m_taps);
+    snapshot.Write(m_buffer);
+    snapshot.Write(m_pos);
+    snapshot.Write(m_started);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return snapshot.Read(m_taps) && snapshot.Read(m_buffer) && snapshot.Read(m_pos) && snapshot.Read(m_started)
+        && m_buffer.size() == DIM * 2 * (m_taps.size() + HISTORY);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorFilter<T>>();
+    ChFunction_Sensor<T>::ArchiveOUT(marchive);
+    std::vector<double> taps = Get_Taps();
+    marchive << make_ChNameValue("m_taps", taps);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorFilter<T>>();
+    ChFunction_Sensor<T>::ArchiveIN(marchive);
+    std::vector<double> taps;
+    marchive >> make_ChNameValue("m_taps", taps);
+    Set_Taps(taps);
+  }
+
+  /// Set the filter coefficients, h[0] applying to the newest input. This resets the filter history.
+  void Set_Taps(const std::vector<double> &Taps) {
+    m_taps.assign(Taps.rbegin(), Taps.rend());
+    m_buffer.assign(DIM * 2 * (m_taps.size() + HISTORY), 0.);
+    m_pos = 0;
+    m_started = false;
+  }
+
+  std::vector<double> Get_Taps() const {
+    return std::vector<double>(m_taps.rbegin(), m_taps.rend());
+  }
+
+  /// Design a Hamming windowed-sinc low pass filter with unit DC gain, for a simulation step and a sample
+  /// period. The cutoff is placed at the Nyquist frequency of the sensor output.
+  void Set_Decimation(const double step, const double sample_rate, const size_t num_taps) {
+    Set_Taps(Design_LowPass(num_taps, 0.5 * step / sample_rate));
+  }
+
+  /// Hamming windowed-sinc low pass filter with unit DC gain; the cutoff is relative to the input rate.
+  static std::vector<double> Design_LowPass(const size_t num_taps, const double cutoff) {
+    std::vector<double> taps(std::max<size_t>(num_taps, 1));
+    double center = 0.5 * (taps.size() - 1.);
+    double sum = 0.;
+    for (size_t k = 0; k < taps.size(); ++k) {
+      double t = k - center;
+      double sinc = t == 0. ? 2. * cutoff : std::sin(2. * CH_C_PI * cutoff * t) / (CH_C_PI * t);
+      double window = taps.size() > 1 ? 0.54 - 0.46 * std::cos(2. * CH_C_PI * k / (taps.size() - 1.)) : 1.;
+      taps[k] = sinc * window;
+      sum += taps[k];
+    }
+    for (auto &tap : taps) {
+      tap /= sum;
+    }
+    return taps;
+  }
+
+ protected:
+  static constexpr size_t DIM = std::is_same<T, double>::value ? 1 : 3;
+  static constexpr size_t HISTORY = 2;  ///< Inputs kept beyond the taps for Get_y_Delayed()
+
+  static double &Component(T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static double Component(const T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  std::vector<double> m_taps;    ///< Reversed coefficients, so they line up with the oldest-first window
+  std::vector<double> m_buffer;  ///< Per component mirrored ring buffer of 2 x (taps + HISTORY) inputs
+  size_t m_pos;
+  bool m_started;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORFILTER_H
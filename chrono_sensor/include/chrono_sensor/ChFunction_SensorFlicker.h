@@ -0,0 +1,173 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORFLICKER_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORFLICKER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "chrono/core/ChMathematics.h"
+#include "ChFunction_SensorNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Flicker (1/f, bias instability) noise on top of the white noise of ChFunction_SensorNoise.
+/// The 1/f spectrum over [f_min, f_max] is approximated recursively by a bank of first order Gauss-Markov
+/// processes with one pole per octave, so each Update() costs a fixed number of draws regardless of the run
+/// length. The bias instability B is the flat floor of the Allan deviation, sqrt(2 ln 2 h_-1).
+template<typename T = double>
+class ChApi ChFunction_SensorFlicker : public ChFunction_SensorNoise<T> {
+ public:
+  ChFunction_SensorFlicker() : ChFunction_SensorNoise<T>(), m_instability(0.), m_time(0.), m_started(false) {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value,
+                  "ChFunction_SensorFlicker requires a double or chrono::ChVector<double> type");
+    Set_Band(1e-3, 1.);
+  };
+
+  ChFunction_SensorFlicker(const T &Instability, const double f_min, const double f_max)
+      : ChFunction_SensorNoise<T>(), m_instability(Instability), m_time(0.), m_started(false) {
+    Set_Band(f_min, f_max);
+  };
+
+  ChFunction_SensorFlicker<T> *Clone() const override {
+    return new ChFunction_SensorFlicker<T>(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_FLICKER;
+  }
+
+  T Get_y(const T &x) const override {
+    return ChFunction_SensorNoise<T>::Get_y(x) + Get_State();
+  };
+
+  void Update(const double x) override {
+    if (m_started && x > m_time) {
+      double dt = x - m_time;
+      if (dt != m_dt) {
+        m_dt = dt;
+        for (size_t k = 0; k < m_tau.size(); ++k) {
+          m_phi[k] = std::exp(-dt / m_tau[k]);
+          m_drive[k] = std::sqrt(1. - m_phi[k] * m_phi[k]);
+        }
+      }
+      T sigma = m_instability * POLE_SCALE;
+      for (size_t k = 0; k < m_tau.size(); ++k) {
+        m_states[k] = m_states[k] * m_phi[k] + this->Get_Noise(T(0.), sigma * m_drive[k]);
+      }
+    }
+    m_started = true;
+    m_time = x;
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    ChFunction_SensorNoise<T>::SnapshotOut(snapshot);
+    snapshot.Write(m_instability);
+    snapshot.Write(m_tau);
+    snapshot.Write(m_phi);
+    snapshot.Write(m_drive);
+    snapshot.Write(m_states);
+    snapshot.Write(m_time);
+    snapshot.Write(m_started);
+    snapshot.Write(m_dt);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return ChFunction_SensorNoise<T>::SnapshotIn(snapshot) && snapshot.Read(m_instability) && snapshot.Read(m_tau)
+        && snapshot.Read(m_phi) && snapshot.Read(m_drive) && snapshot.Read(m_states) && snapshot.Read(m_time)
+        && snapshot.Read(m_started) && snapshot.Read(m_dt);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorFlicker<T>>();
+    ChFunction_SensorNoise<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_instability);
+    marchive << CHNVP(m_tau);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorFlicker<T>>();
+    ChFunction_SensorNoise<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_instability);
+    marchive >> CHNVP(m_tau);
+    m_phi.assign(m_tau.size(), 1.);
+    m_drive.assign(m_tau.size(), 0.);
+    m_states.assign(m_tau.size(), T(0.));
+    m_dt = -1.;
+  }
+
+  const T &Get_Instability() const {
+    return m_instability;
+  }
+
+  void Set_Instability(const T &Instability) {
+    m_instability = Instability;
+  }
+
+  /// Set the frequency band [Hz] over which the spectrum follows 1/f; this resets the state.
+  void Set_Band(const double f_min, const double f_max) {
+    size_t poles = static_cast<size_t>(std::max(1., std::ceil(std::log2(f_max / f_min))));
+    m_tau.resize(poles);
+    for (size_t k = 0; k < poles; ++k) {
+      // Pole frequencies at the geometric centre of each octave
+      m_tau[k] = 1. / (2. * CH_C_PI * f_min * std::pow(2., k + 0.5));
+    }
+    m_phi.assign(poles, 1.);
+    m_drive.assign(poles, 0.);
+    m_states.assign(poles, T(0.));
+    m_dt = -1.;
+  }
+
+  size_t Get_Poles() const {
+    return m_tau.size();
+  }
+
+  T Get_State() const {
+    T state(0.);
+    for (const auto &s : m_states) {
+      state += s;
+    }
+    return state;
+  }
+
+ protected:
+  // Each octave pole carries the 1/f power of its octave, h_-1 ln 2, i.e. a variance of B^2 / 2
+  static constexpr double POLE_SCALE = 0.70710678118654752440;
+
+  T m_instability;
+  std::vector<double> m_tau;
+  std::vector<double> m_phi;
+  std::vector<double> m_drive;
+  std::vector<T> m_states;
+  double m_time;
+  bool m_started;
+  double m_dt;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORFLICKER_H
@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORGAUSSMARKOV_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORGAUSSMARKOV_H
+
+#include <cmath>
+
+#include "ChFunction_SensorNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// First order Gauss-Markov drift on top of the white noise of ChFunction_SensorNoise. The drift is advanced
+/// in Update() with the exact discretization of the process, so the result doesn't depend on the step size:
+/// b(t + dt) = exp(-dt / tau) b(t) + N(0, sigma^2 (1 - exp(-2 dt / tau))),
+/// with sigma the steady state standard deviation and tau the correlation time.
+template<typename T = double>
+class ChApi ChFunction_SensorGaussMarkov : public ChFunction_SensorNoise<T> {
+ public:
+  ChFunction_SensorGaussMarkov()
+      : ChFunction_SensorNoise<T>(), m_sigma(0.), m_tau(1.), m_state(0.), m_time(0.), m_started(false),
+        m_dt(-1.), m_phi(1.), m_drive(0.) {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value,
+                  "ChFunction_SensorGaussMarkov requires a double or chrono::ChVector<double> type");
+  };
+
+  ChFunction_SensorGaussMarkov(const T &Sigma, const double Tau)
+      : ChFunction_SensorNoise<T>(), m_sigma(Sigma), m_tau(Tau), m_state(0.), m_time(0.), m_started(false),
+        m_dt(-1.), m_phi(1.), m_drive(0.) {};
+
+  ChFunction_SensorGaussMarkov<T> *Clone() const override {
+    return new ChFunction_SensorGaussMarkov<T>(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_GAUSS_MARKOV;
+  }
+
+  T Get_y(const T &x) const override {
+    return ChFunction_SensorNoise<T>::Get_y(x) + m_state;
+  };
+
+  void Update(const double x) override {
+    if (m_started && x > m_time) {
+      Step(x - m_time);
+    }
+    m_started = true;
+    m_time = x;
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    ChFunction_SensorNoise<T>::SnapshotOut(snapshot);
+    snapshot.Write(m_sigma);
+    snapshot.Write(m_tau);
+    snapshot.Write(m_state);
+    snapshot.Write(m_time);
+    snapshot.Write(m_started);
+    snapshot.Write(m_dt);
+    snapshot.Write(m_phi);
+    snapshot.Write(m_drive);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return ChFunction_SensorNoise<T>::SnapshotIn(snapshot) && snapshot.Read(m_sigma) && snapshot.Read(m_tau)
+        && snapshot.Read(m_state) && snapshot.Read(m_time) && snapshot.Read(m_started) && snapshot.Read(m_dt)
+        && snapshot.Read(m_phi) && snapshot.Read(m_drive);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorGaussMarkov<T>>();
+    ChFunction_SensorNoise<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_sigma);
+    marchive << CHNVP(m_tau);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorGaussMarkov<T>>();
+    ChFunction_SensorNoise<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_sigma);
+    marchive >> CHNVP(m_tau);
+    m_dt = -1.;
+  }
+
+  const T &Get_Sigma() const {
+    return m_sigma;
+  }
+
+  void Set_Sigma(const T &Sigma) {
+    m_sigma = Sigma;
+    m_dt = -1.;
+  }
+
+  double Get_Tau() const {
+    return m_tau;
+  }
+
+  void Set_Tau(const double Tau) {
+    m_tau = Tau;
+    m_dt = -1.;
+  }
+
+  const T &Get_State() const {
+    return m_state;
+  }
+
+  void Set_State(const T &State) {
+    m_state = State;
+  }
+
+ protected:
+  void Step(const double dt) {
+    // Sensors mostly sample at a fixed rate, so only recompute the transition when the step changes
+    if (dt != m_dt) {
+      m_dt = dt;
+      m_phi = std::exp(-dt / m_tau);
+      m_drive = m_sigma * std::sqrt(1. - m_phi * m_phi);
+    }
+    m_state = m_state * m_phi + this->Get_Noise(T(0.), m_drive);
+  }
+
+  T m_sigma;
+  double m_tau;
+  T m_state;
+  double m_time;
+  bool m_started;
+  double m_dt;
+  double m_phi;
+  T m_drive;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORGAUSSMARKOV_H
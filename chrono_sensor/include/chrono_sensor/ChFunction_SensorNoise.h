@@ -24,10 +24,16 @@
 #ifndef CHRONO_SENSOR_CHFUNCTION_SENSORNOISE_H
 #define CHRONO_SENSOR_CHFUNCTION_SENSORNOISE_H
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
 #include <random>
+#include <vector>
 #include <chrono>
 
 #include "ChFunction_Sensor.h"
+#include "ChFunction_SensorBias.h"
 
 #include "chrono/core/ChVectorDynamic.h"
 #include "chrono/core/ChVector.h"
@@ -37,10 +43,17 @@ namespace chrono {
 namespace vehicle {
 namespace sensor {
 
+/// Additive gaussian noise (multiplicative for quaternions). The components are independent unless a full
+/// covariance is set, in which case its Cholesky factor L correlates a vector of standard normals z: n = mean + L z.
 template<typename T = double>
 class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
  public:
-  ChFunction_SensorNoise() : m_mean(0.), m_stddev(0.) {
+  static constexpr size_t DIM = std::is_same<T, double>::value ? 1 : (std::is_same<T, ChVector<>>::value ? 3 : 4);
+
+  /// Row major DIM x DIM matrix.
+  using Covariance = std::array<double, DIM * DIM>;
+
+  ChFunction_SensorNoise() : m_mean(0.), m_stddev(0.), m_correlated(false) {
     static_assert(
         std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value || std::is_same<T, ChQuaternion<>>::value,
         "ChFunction_SensorNoise requires a double, chrono::ChVector<double> of ChQuaternion<double> type");
@@ -49,14 +62,15 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
 
   ChFunction_SensorNoise(const T &Mean,
                          const T &Stddev)
-      : m_mean(1), m_stddev(1) {
+      : m_mean(1), m_stddev(1), m_correlated(false) {
     m_mean = Mean;
     m_stddev = Stddev;
     m_gen = std::make_shared<std::default_random_engine>(Get_Seed());
   };
 
   ChFunction_SensorNoise(const ChFunction_Sensor<T> &other)
-      : m_mean(other.m_mean), m_stddev(other.m_stddev), m_gen(other.m_gen) {};
+      : m_mean(other.m_mean), m_stddev(other.m_stddev), m_cholesky(other.m_cholesky),
+        m_correlated(other.m_correlated), m_gen(other.m_gen) {};
 
   ChFunction_SensorNoise<T> *Clone() const override {
     return new ChFunction_SensorNoise<T>(*this);
@@ -65,7 +79,8 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
   bool operator==(const ChFunction_SensorNoise &rhs) const {
     return m_gen == rhs.m_gen &&
         static_cast<T>(m_mean) == static_cast<T>(rhs.m_mean) &&
-        static_cast<T>(m_stddev) == static_cast<T>(rhs.m_stddev);
+        static_cast<T>(m_stddev) == static_cast<T>(rhs.m_stddev) &&
+        m_correlated == rhs.m_correlated && (!m_correlated || m_cholesky == rhs.m_cholesky);
   }
 
   bool operator!=(const ChFunction_SensorNoise &rhs) const {
@@ -78,13 +93,123 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
 
   T Get_y(const T &x) const override {
     if constexpr(std::is_same<T, ChQuaternion<>>::value) {
-      return x * Get_Noise(m_mean, m_stddev);
+      return x * (m_correlated ? Get_CorrelatedNoise(m_mean) : Get_Noise(m_mean, m_stddev));
+    } else if (m_correlated) {
+      return x + Get_CorrelatedNoise(m_mean);
     } else {
       return x + Get_Noise(m_mean, m_stddev);
     }
   };
 
-  T &Get_Mean() const {
+  void Get_y_Batch(const T *x, T *y, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      // Each perturbation, correlated or not, is composed with its sample by Get_y
+      ChFunction_Sensor<T>::Get_y_Batch(x, y, n);
+    } else if (!m_correlated) {
+      ChFunction_Sensor<T>::Get_y_Batch(x, y, n);
+    } else {
+      // Draw all the standard normals first, then apply the factor in place: going up from the last row, each
+      // row only reads the normals of the rows above it, which haven't been overwritten yet.
+      std::normal_distribution<double> dist;
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t r = 0; r < DIM; ++r) {
+          Component(y[i], r) = dist(*m_gen);
+        }
+      }
+      for (size_t r = DIM; r-- > 0;) {
+        const double *l = m_cholesky.data() + r * DIM;
+        const double mean = Component(m_mean, r);
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+          double acc = mean;
+          for (size_t j = 0; j <= r; ++j) {
+            acc += l[j] * Component(y[i], j);
+          }
+          Component(y[i], r) = acc;
+        }
+      }
+      for (size_t i = 0; i < n; ++i) {
+        y[i] += x[i];
+      }
+    }
+  }
+
+  /// The derivatives are those of the noise free transform: the additive noise has a unit (element wise)
+  /// slope, so no random numbers are drawn. For quaternions the mean rotation is differentiated numerically.
+  T Get_y_dx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return Mean_Transform().Get_y_dx(x);
+    } else {
+      return T(1.);
+    }
+  }
+
+  T Get_y_dxdx(const T &x) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      return Mean_Transform().Get_y_dxdx(x);
+    } else {
+      return T(0.);
+    }
+  }
+
+  void Get_y_dx_Batch(const T *x, T *dydx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      Mean_Transform().Get_y_dx_Batch(x, dydx, n);
+    } else {
+      std::fill(dydx, dydx + n, T(1.));
+    }
+  }
+
+  void Get_y_dxdx_Batch(const T *x, T *dydxdx, size_t n) const override {
+    if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+      Mean_Transform().Get_y_dxdx_Batch(x, dydxdx, n);
+    } else {
+      std::fill(dydxdx, dydxdx + n, T(0.));
+    }
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    snapshot.Write(m_mean);
+    snapshot.Write(m_stddev);
+    snapshot.Write(m_cholesky);
+    snapshot.Write(m_correlated);
+    snapshot.Write_Engine(*m_gen);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return snapshot.Read(m_mean) && snapshot.Read(m_stddev) && snapshot.Read(m_cholesky)
+        && snapshot.Read(m_correlated) && snapshot.Read_Engine(*m_gen);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorNoise<T>>();
+    ChFunction_Sensor<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_mean);
+    marchive << CHNVP(m_stddev);
+    marchive << CHNVP(m_correlated);
+    Covariance covariance = Get_Covariance();
+    std::vector<double> values(covariance.begin(), covariance.end());
+    marchive << make_ChNameValue("m_covariance", values);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorNoise<T>>();
+    ChFunction_Sensor<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_mean);
+    marchive >> CHNVP(m_stddev);
+    bool correlated = false;
+    std::vector<double> values;
+    marchive >> make_ChNameValue("m_correlated", correlated);
+    marchive >> make_ChNameValue("m_covariance", values);
+    m_correlated = false;
+    if (correlated && values.size() == DIM * DIM) {
+      Covariance covariance;
+      std::copy(values.begin(), values.end(), covariance.begin());
+      Set_Covariance(covariance);
+    }
+  }
+
+  const T &Get_Mean() const {
     return m_mean;
   }
 
@@ -92,12 +217,67 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
     m_mean = Mean;
   }
 
-  T &Get_Stddev() const {
+  const T &Get_Stddev() const {
     return m_stddev;
   }
 
+  /// Set independent component standard deviations, clearing any covariance.
   void Set_Stddev(const T &Stddev) {
     m_stddev = Stddev;
+    m_correlated = false;
+  }
+
+  /// Set a full (row major) covariance matrix and factorize it once. Fails and leaves the noise unchanged if it
+  /// isn't symmetric positive definite. The standard deviations become the square roots of its diagonal.
+  bool Set_Covariance(const Covariance &covariance) {
+    Covariance l{};
+    for (size_t r = 0; r < DIM; ++r) {
+      for (size_t c = 0; c <= r; ++c) {
+        if (std::abs(covariance[r * DIM + c] - covariance[c * DIM + r])
+            > 1e-12 * (std::abs(covariance[r * DIM + c]) + std::abs(covariance[c * DIM + r]))) {
+          return false;
+        }
+        double sum = covariance[r * DIM + c];
+        for (size_t k = 0; k < c; ++k) {
+          sum -= l[r * DIM + k] * l[c * DIM + k];
+        }
+        if (r == c) {
+          if (!(sum > 0.)) {
+            return false;
+          }
+          l[r * DIM + r] = std::sqrt(sum);
+        } else {
+          l[r * DIM + c] = sum / l[c * DIM + c];
+        }
+      }
+    }
+    m_cholesky = l;
+    m_correlated = true;
+    for (size_t r = 0; r < DIM; ++r) {
+      Component(m_stddev, r) = std::sqrt(covariance[r * DIM + r]);
+    }
+    return true;
+  }
+
+  /// Return the covariance matrix, diagonal for independent components.
+  Covariance Get_Covariance() const {
+    Covariance covariance{};
+    for (size_t r = 0; r < DIM; ++r) {
+      for (size_t c = 0; c < DIM; ++c) {
+        if (m_correlated) {
+          for (size_t k = 0; k <= std::min(r, c); ++k) {
+            covariance[r * DIM + c] += m_cholesky[r * DIM + k] * m_cholesky[c * DIM + k];
+          }
+        } else if (r == c) {
+          covariance[r * DIM + c] = Component(m_stddev, r) * Component(m_stddev, r);
+        }
+      }
+    }
+    return covariance;
+  }
+
+  bool Is_Correlated() const {
+    return m_correlated;
   }
 
  protected:
@@ -109,6 +289,8 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
     return seed;
   };
 
+  /// Independent normal draw per component. Derived drift models use it for their own increments, so it ignores
+  /// the covariance of the white noise.
   T Get_Noise(const T &mean, const T &stddev) const {
     if constexpr(std::is_same<T, double>::value) {
       return Get_Noise_Scalar(mean, stddev);
@@ -127,6 +309,42 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
     }
   };
 
+  /// Correlated white noise draw: mean + L z.
+  T Get_CorrelatedNoise(const T &mean) const {
+    std::array<double, DIM> z;
+    std::normal_distribution<double> dist;
+    for (auto &z_i : z) {
+      z_i = dist(*m_gen);
+    }
+    T ret = mean;
+    for (size_t r = 0; r < DIM; ++r) {
+      for (size_t c = 0; c <= r; ++c) {
+        Component(ret, r) += m_cholesky[r * DIM + c] * z[c];
+      }
+    }
+    return ret;
+  }
+
+  static double &Component(T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static double Component(const T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  ChFunction_SensorBias<T> Mean_Transform() const {
+    return ChFunction_SensorBias<T>(m_mean);
+  }
+
   double Get_Noise_Scalar(const double &mean, const double &stddev) const {
     std::normal_distribution<double> dist(mean, stddev);
     return dist(*m_gen);
@@ -134,6 +352,8 @@ class ChApi ChFunction_SensorNoise : public ChFunction_Sensor<T> {
 
   T m_mean;
   T m_stddev;
+  Covariance m_cholesky;  ///< Lower triangular factor, only used when correlated
+  bool m_correlated;
   std::shared_ptr<std::default_random_engine> m_gen;
 };
 } /// sensor
@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORORIENTATIONNOISE_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORORIENTATIONNOISE_H
+
+#include <cmath>
+
+#include "ChFunction_Sensor.h"
+#include "ChFunction_SensorBias.h"
+#include "ChFunction_SensorNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Attitude noise for orientation sensors: a gaussian rotation vector theta (3 normals, in the body frame) is
+/// mapped to a unit quaternion by the exponential map and composed with the input, y = x * exp(theta).
+/// The rotation vector is drawn by a ChFunction_SensorNoise<ChVector<>>, so it supports a mean (misalignment)
+/// and a full covariance. The result stays unit length for unit inputs, no normalization is needed.
+class ChApi ChFunction_SensorOrientationNoise : public ChFunction_Sensor<ChQuaternion<>> {
+ public:
+  ChFunction_SensorOrientationNoise() : m_rotation(ChVector<>(0.), ChVector<>(0.)) {};
+
+  /// Mean and standard deviation of the rotation vector components [rad].
+  ChFunction_SensorOrientationNoise(const ChVector<> &Mean, const ChVector<> &Stddev) : m_rotation(Mean, Stddev) {};
+
+  ChFunction_SensorOrientationNoise *Clone() const override {
+    return new ChFunction_SensorOrientationNoise(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_ORIENTATION_NOISE;
+  }
+
+  ChQuaternion<> Get_y(const ChQuaternion<> &x) const override {
+    return x * Exp_Map(m_rotation.Get_y(ChVector<>(0.)));
+  }
+
+  /// Draws all the rotation vectors, then applies the exponential map and the product in a vectorizable loop.
+  void Get_y_Batch(const ChQuaternion<> *x, ChQuaternion<> *y, size_t n) const override {
+    for (size_t i = 0; i < n; ++i) {
+      y[i] = ChQuaternion<>(0., m_rotation.Get_y(ChVector<>(0.)));
+    }
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+      double c, s;
+      Exp_Coefficients(0.25 * (y[i][1] * y[i][1] + y[i][2] * y[i][2] + y[i][3] * y[i][3]), c, s);
+      s *= 0.5;
+      const double q0 = c, q1 = s * y[i][1], q2 = s * y[i][2], q3 = s * y[i][3];
+      const ChQuaternion<> &p = x[i];
+      y[i][0] = p[0] * q0 - p[1] * q1 - p[2] * q2 - p[3] * q3;
+      y[i][1] = p[0] * q1 + p[1] * q0 + p[2] * q3 - p[3] * q2;
+      y[i][2] = p[0] * q2 + p[2] * q0 + p[3] * q1 - p[1] * q3;
+      y[i][3] = p[0] * q3 + p[3] * q0 + p[1] * q2 - p[2] * q1;
+    }
+  }
+
+  /// Derivatives of the noise free rotation by the mean, no random numbers are drawn.
+  ChQuaternion<> Get_y_dx(const ChQuaternion<> &x) const override {
+    return ChFunction_SensorBias<ChQuaternion<>>(Exp_Map(Get_Mean())).Get_y_dx(x);
+  }
+
+  ChQuaternion<> Get_y_dxdx(const ChQuaternion<> &x) const override {
+    return ChFunction_SensorBias<ChQuaternion<>>(Exp_Map(Get_Mean())).Get_y_dxdx(x);
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    m_rotation.SnapshotOut(snapshot);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return m_rotation.SnapshotIn(snapshot);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorOrientationNoise>();
+    ChFunction_Sensor<ChQuaternion<>>::ArchiveOUT(marchive);
+    m_rotation.ArchiveOUT(marchive);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorOrientationNoise>();
+    ChFunction_Sensor<ChQuaternion<>>::ArchiveIN(marchive);
+    m_rotation.ArchiveIN(marchive);
+  }
+
+  const ChVector<> &Get_Mean() const {
+    return m_rotation.Get_Mean();
+  }
+
+  void Set_Mean(const ChVector<> &Mean) {
+    m_rotation.Set_Mean(Mean);
+  }
+
+  const ChVector<> &Get_Stddev() const {
+    return m_rotation.Get_Stddev();
+  }
+
+  void Set_Stddev(const ChVector<> &Stddev) {
+    m_rotation.Set_Stddev(Stddev);
+  }
+
+  /// Set the covariance of the rotation vector [rad^2].
+  bool Set_Covariance(const ChFunction_SensorNoise<ChVector<>>::Covariance &covariance) {
+    return m_rotation.Set_Covariance(covariance);
+  }
+
+  ChFunction_SensorNoise<ChVector<>>::Covariance Get_Covariance() const {
+    return m_rotation.Get_Covariance();
+  }
+
+  /// Unit quaternion of the rotation vector theta.
+  static ChQuaternion<> Exp_Map(const ChVector<> &theta) {
+    double c, s;
+    Exp_Coefficients(0.25 * theta.Length2(), c, s);
+    return ChQuaternion<>(c, theta * (0.5 * s));
+  }
+
+  /// Rotation vector of a unit quaternion, on the shortest arc.
+  static ChVector<> Log_Map(const ChQuaternion<> &q) {
+    ChVector<> v = q.GetVector();
+    double s = v.Length();
+    double w = q.e0();
+    if (w < 0.) {
+      v = -v;
+      w = -w;
+    }
+    if (s < 1e-12) {
+      return v * (2. / w);
+    }
+    return v * (2. * std::atan2(s, w) / s);
+  }
+
+ protected:
+  /// cos(h) and sin(h) / h for the half angle h, given h^2. Below 10 mrad the fourth order Taylor series is
+  /// exact to machine precision and avoids the trigonometric calls.
+  static void Exp_Coefficients(const double h2, double &c, double &s) {
+    if (h2 < 1e-4) {
+      c = 1. - h2 / 2. + h2 * h2 / 24.;
+      s = 1. - h2 / 6. + h2 * h2 / 120.;
+    } else {
+      double h = std::sqrt(h2);
+      c = std::cos(h);
+      s = std::sin(h) / h;
+    }
+  }
+
+  ChFunction_SensorNoise<ChVector<>> m_rotation;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORORIENTATIONNOISE_H
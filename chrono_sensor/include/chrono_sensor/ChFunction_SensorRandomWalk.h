@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORRANDOMWALK_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORRANDOMWALK_H
+
+#include <cmath>
+
+#include "ChFunction_SensorNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Bias random walk on top of the white noise of ChFunction_SensorNoise. The bias is advanced in Update(),
+/// with a single normal draw per component: b(t + dt) = b(t) + N(0, q^2 dt), q being the random walk
+/// intensity [unit/sqrt(s)].
+template<typename T = double>
+class ChApi ChFunction_SensorRandomWalk : public ChFunction_SensorNoise<T> {
+ public:
+  ChFunction_SensorRandomWalk() : ChFunction_SensorNoise<T>(), m_intensity(0.), m_state(0.), m_time(0.), m_started(false) {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value,
+                  "ChFunction_SensorRandomWalk requires a double or chrono::ChVector<double> type");
+  };
+
+  explicit ChFunction_SensorRandomWalk(const T &Intensity)
+      : ChFunction_SensorNoise<T>(), m_intensity(Intensity), m_state(0.), m_time(0.), m_started(false) {};
+
+  ChFunction_SensorRandomWalk<T> *Clone() const override {
+    return new ChFunction_SensorRandomWalk<T>(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_RANDOM_WALK;
+  }
+
+  T Get_y(const T &x) const override {
+    return ChFunction_SensorNoise<T>::Get_y(x) + m_state;
+  };
+
+  void Update(const double x) override {
+    if (m_started && x > m_time) {
+      m_state += this->Get_Noise(T(0.), m_intensity * std::sqrt(x - m_time));
+    }
+    m_started = true;
+    m_time = x;
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    ChFunction_SensorNoise<T>::SnapshotOut(snapshot);
+    snapshot.Write(m_intensity);
+    snapshot.Write(m_state);
+    snapshot.Write(m_time);
+    snapshot.Write(m_started);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    return ChFunction_SensorNoise<T>::SnapshotIn(snapshot) && snapshot.Read(m_intensity) && snapshot.Read(m_state)
+        && snapshot.Read(m_time) && snapshot.Read(m_started);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorRandomWalk<T>>();
+    ChFunction_SensorNoise<T>::ArchiveOUT(marchive);
+    marchive << CHNVP(m_intensity);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorRandomWalk<T>>();
+    ChFunction_SensorNoise<T>::ArchiveIN(marchive);
+    marchive >> CHNVP(m_intensity);
+  }
+
+  const T &Get_Intensity() const {
+    return m_intensity;
+  }
+
+  void Set_Intensity(const T &Intensity) {
+    m_intensity = Intensity;
+  }
+
+  const T &Get_State() const {
+    return m_state;
+  }
+
+  void Set_State(const T &State) {
+    m_state = State;
+  }
+
+ protected:
+  T m_intensity;
+  T m_state;
+  double m_time;
+  bool m_started;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORRANDOMWALK_H
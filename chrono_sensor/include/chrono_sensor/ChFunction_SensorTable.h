@@ -0,0 +1,317 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHFUNCTION_SENSORTABLE_H
+#define CHRONO_SENSOR_CHFUNCTION_SENSORTABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chrono/core/ChMatrix33.h"
+#include "chrono/motion_functions/ChFunction.h"
+#include "ChFunction_Sensor.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Calibration curve transform: each axis is mapped through a lookup table sampled on a uniform grid, then an
+/// optional 3x3 misalignment (cross-axis coupling) matrix is applied to vectors.
+/// Each table cell stores its value and slope, so a lookup is one multiply for the index and one fused
+/// multiply-add for the interpolation. Inputs outside the table are clamped to its end values.
+/// Axes without a table pass their input through unchanged.
+template<typename T = double>
+class ChApi ChFunction_SensorTable : public ChFunction_Sensor<T> {
+ public:
+  ChFunction_SensorTable() : m_misaligned(false), m_misalignment(1.) {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, ChVector<>>::value,
+                  "ChFunction_SensorTable requires a double or chrono::ChVector<double> type");
+  };
+
+  ChFunction_SensorTable(const double x_min, const double x_max, const std::vector<double> &values)
+      : ChFunction_SensorTable() {
+    for (size_t c = 0; c < DIM; ++c) {
+      Set_Table(x_min, x_max, values, c);
+    }
+  }
+
+  ChFunction_SensorTable<T> *Clone() const override {
+    return new ChFunction_SensorTable<T>(*this);
+  };
+
+  FunctionType Get_Type() const override {
+    return FUNCT_TABLE;
+  }
+
+  T Get_y(const T &x) const override {
+    T y = x;
+    for (size_t c = 0; c < DIM; ++c) {
+      if (!m_axes[c].cells.empty()) {
+        Component(y, c) = m_axes[c].Lookup(Component(x, c));
+      }
+    }
+    if constexpr(std::is_same<T, ChVector<>>::value) {
+      if (m_misaligned) {
+        y = m_misalignment * y;
+      }
+    }
+    return y;
+  }
+
+  void Get_y_Batch(const T *x, T *y, size_t n) const override {
+    for (size_t c = 0; c < DIM; ++c) {
+      const Axis &axis = m_axes[c];
+      if (axis.cells.empty()) {
+        for (size_t i = 0; i < n; ++i) {
+          Component(y[i], c) = Component(x[i], c);
+        }
+        continue;
+      }
+      const Cell *cells = axis.cells.data();
+      const double x0 = axis.x0;
+      const double inv_dx = axis.inv_dx;
+      const double u_max = axis.u_max;
+#pragma omp simd
+      for (size_t i = 0; i < n; ++i) {
+        double xi = Component(x[i], c);
+        double u = (xi - x0) * inv_dx;
+        u = u > 0. ? std::min(u, u_max) : 0.;
+        auto k = static_cast<size_t>(u);
+        double yi = cells[k].value + cells[k].slope * (u - k);
+        Component(y[i], c) = xi == xi ? yi : xi;
+      }
+    }
+    if constexpr(std::is_same<T, ChVector<>>::value) {
+      if (m_misaligned) {
+        for (size_t i = 0; i < n; ++i) {
+          y[i] = m_misalignment * y[i];
+        }
+      }
+    }
+  }
+
+  /// Set the table of one axis from values sampled uniformly over [x_min, x_max] (at least two values).
+  void Set_Table(const double x_min, const double x_max, const std::vector<double> &values, const size_t axis = 0) {
+    Axis &table = m_axes[axis];
+    table.cells.clear();
+    if (values.size() < 2 || !(x_max > x_min)) {
+      return;
+    }
+    table.x0 = x_min;
+    table.inv_dx = (values.size() - 1) / (x_max - x_min);
+    // The last cell is only reached by clamped inputs, it holds the end value with a zero slope
+    table.u_max = values.size() - 1;
+    table.cells.resize(values.size());
+    for (size_t i = 0; i + 1 < values.size(); ++i) {
+      table.cells[i] = {values[i], values[i + 1] - values[i]};
+    }
+    table.cells.back() = {values.back(), 0.};
+  }
+
+  /// Sample a function on num_points uniform points over [x_min, x_max] for one axis.
+  void Set_Table(const ChFunction &function, const double x_min, const double x_max, const size_t num_points,
+                 const size_t axis = 0) {
+    std::vector<double> values(std::max<size_t>(num_points, 2));
+    for (size_t i = 0; i < values.size(); ++i) {
+      values[i] = function.Get_y(x_min + (x_max - x_min) * i / (values.size() - 1));
+    }
+    Set_Table(x_min, x_max, values, axis);
+  }
+
+  /// Remove the table of an axis, so its input passes through.
+  void Clear_Table(const size_t axis = 0) {
+    m_axes[axis].cells.clear();
+  }
+
+  /// Return the table values of an axis.
+  std::vector<double> Get_Table(const size_t axis = 0) const {
+    std::vector<double> values;
+    values.reserve(m_axes[axis].cells.size());
+    for (auto &cell : m_axes[axis].cells) {
+      values.push_back(cell.value);
+    }
+    return values;
+  }
+
+  /// Load the tables from a text file with one row per grid point: x y (or x y_x y_y y_z for vectors).
+  /// Empty lines and lines starting with '#' are skipped, commas are accepted as separators.
+  /// Fails if the file has less than two rows, a short row or a non uniform x column.
+  bool Load(const std::string &filename) {
+    std::ifstream in(filename);
+    if (!in) {
+      return false;
+    }
+    std::vector<double> xs;
+    std::array<std::vector<double>, DIM> columns;
+    std::string line;
+    while (std::getline(in, line)) {
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::istringstream row(line);
+      double x;
+      if (line.empty() || line[0] == '#' || !(row >> x)) {
+        continue;
+      }
+      xs.push_back(x);
+      for (size_t c = 0; c < DIM; ++c) {
+        double y;
+        if (!(row >> y)) {
+          return false;
+        }
+        columns[c].push_back(y);
+      }
+    }
+    if (xs.size() < 2) {
+      return false;
+    }
+    double dx = (xs.back() - xs.front()) / (xs.size() - 1);
+    for (size_t i = 0; i < xs.size(); ++i) {
+      if (std::abs(xs[i] - (xs.front() + i * dx)) > 1e-6 * std::abs(dx)) {
+        return false;
+      }
+    }
+    for (size_t c = 0; c < DIM; ++c) {
+      Set_Table(xs.front(), xs.back(), columns[c], c);
+    }
+    return true;
+  }
+
+  void SnapshotOut(ChSensorSnapshot &snapshot) const override {
+    for (const auto &axis : m_axes) {
+      snapshot.Write(axis.x0);
+      snapshot.Write(axis.inv_dx);
+      snapshot.Write(axis.u_max);
+      snapshot.Write(axis.cells);
+    }
+    snapshot.Write(m_misaligned);
+    snapshot.Write(m_misalignment);
+  }
+
+  bool SnapshotIn(ChSensorSnapshot &snapshot) override {
+    for (auto &axis : m_axes) {
+      if (!(snapshot.Read(axis.x0) && snapshot.Read(axis.inv_dx) && snapshot.Read(axis.u_max)
+          && snapshot.Read(axis.cells)))
+        return false;
+    }
+    return snapshot.Read(m_misaligned) && snapshot.Read(m_misalignment);
+  }
+
+  void ArchiveOUT(ChArchiveOut &marchive) override {
+    marchive.VersionWrite<ChFunction_SensorTable<T>>();
+    ChFunction_Sensor<T>::ArchiveOUT(marchive);
+    for (size_t c = 0; c < DIM; ++c) {
+      double x_min = m_axes[c].x0;
+      double x_max = m_axes[c].inv_dx > 0. ? x_min + m_axes[c].u_max / m_axes[c].inv_dx : x_min;
+      std::vector<double> values = Get_Table(c);
+      marchive << make_ChNameValue("x_min", x_min);
+      marchive << make_ChNameValue("x_max", x_max);
+      marchive << make_ChNameValue("values", values);
+    }
+    marchive << CHNVP(m_misaligned);
+    marchive << CHNVP(m_misalignment);
+  }
+
+  void ArchiveIN(ChArchiveIn &marchive) override {
+    marchive.VersionRead<ChFunction_SensorTable<T>>();
+    ChFunction_Sensor<T>::ArchiveIN(marchive);
+    for (size_t c = 0; c < DIM; ++c) {
+      double x_min = 0.;
+      double x_max = 0.;
+      std::vector<double> values;
+      marchive >> make_ChNameValue("x_min", x_min);
+      marchive >> make_ChNameValue("x_max", x_max);
+      marchive >> make_ChNameValue("values", values);
+      Set_Table(x_min, x_max, values, c);
+    }
+    marchive >> CHNVP(m_misaligned);
+    marchive >> CHNVP(m_misalignment);
+  }
+
+  /// Set the misalignment matrix applied after the tables (vectors only).
+  void Set_Misalignment(const ChMatrix33<> &misalignment) {
+    m_misalignment = misalignment;
+    m_misaligned = true;
+  }
+
+  const ChMatrix33<> &Get_Misalignment() const {
+    return m_misalignment;
+  }
+
+  void Clear_Misalignment() {
+    m_misalignment = ChMatrix33<>(1.);
+    m_misaligned = false;
+  }
+
+ protected:
+  static constexpr size_t DIM = std::is_same<T, double>::value ? 1 : 3;
+
+  struct Cell {
+    double value;
+    double slope;  ///< Change of value over the cell
+  };
+
+  struct Axis {
+    /// Clamped lookup; the comparisons also send a NaN index to the first cell, a NaN input is returned as is.
+    double Lookup(const double x) const {
+      if (x != x)
+        return x;
+      double u = (x - x0) * inv_dx;
+      u = u > 0. ? std::min(u, u_max) : 0.;
+      auto k = static_cast<size_t>(u);
+      return cells[k].value + cells[k].slope * (u - k);
+    }
+
+    double x0 = 0.;
+    double inv_dx = 0.;
+    double u_max = 0.;
+    std::vector<Cell> cells;
+  };
+
+  static double &Component(T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static double Component(const T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  std::array<Axis, DIM> m_axes;
+  bool m_misaligned;
+  ChMatrix33<> m_misalignment;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHFUNCTION_SENSORTABLE_H
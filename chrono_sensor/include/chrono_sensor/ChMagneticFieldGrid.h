@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHMAGNETICFIELDGRID_H
+#define CHRONO_SENSOR_CHMAGNETICFIELDGRID_H
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chrono_sensor/ChMagneticFieldModel.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Magnetic field model sampled once on a regular 3D grid over the scenario bounding box.
+/// Lookups use trilinear interpolation; positions outside the box are clamped to its boundary.
+class CH_VEHICLE_API ChMagneticFieldGrid {
+ public:
+  ChMagneticFieldGrid();
+
+  /// Sample the field model over the box [min, max] with (at most) the given node spacing [m].
+  /// If a cache file name is given, a matching cached grid is loaded instead of sampling the model,
+  /// and a freshly sampled grid is written to it.
+  /// Fails and leaves the grid unchanged if the spacing isn't positive or the box is inverted.
+  bool Initialize(const ChMagneticFieldModel &model,
+                  const ChVector<> &min,
+                  const ChVector<> &max,
+                  const double spacing,
+                  const std::string &cache_filename = "");
+
+  /// Return the interpolated magnetic flux density [T] at the given position.
+  ChVector<> Get_Field(const ChVector<> &pos) const;
+
+  /// Write the grid to a binary cache file.
+  bool Save(const std::string &filename) const;
+
+  /// Load the grid from a binary cache file. Fails if the file was generated for a different model hash.
+  bool Load(const std::string &filename, const uint64_t hash);
+
+  const ChVector<> &Get_Min() const { return m_min; }
+
+  const ChVector<> &Get_Max() const { return m_max; }
+
+  const std::array<int, 3> &Get_Dimensions() const { return m_dim; }
+
+ private:
+  size_t Index(const int i, const int j, const int k) const {
+    return 3 * (static_cast<size_t>(k) * m_dim[1] * m_dim[0] + static_cast<size_t>(j) * m_dim[0] + i);
+  }
+
+  ChVector<> m_min;
+  ChVector<> m_max;
+  ChVector<> m_inv_spacing;
+  std::array<int, 3> m_dim;
+  uint64_t m_hash;
+  std::vector<double> m_field;  ///< Interleaved x, y, z components, x index running fastest
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHMAGNETICFIELDGRID_H
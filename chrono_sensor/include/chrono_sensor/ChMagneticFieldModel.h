@@ -0,0 +1,90 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHMAGNETICFIELDMODEL_H
+#define CHRONO_SENSOR_CHMAGNETICFIELDMODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chrono/core/ChVector.h"
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Base class for a magnetic field model, evaluated in the (Z up) simulation frame.
+class CH_VEHICLE_API ChMagneticFieldModel {
+ public:
+  virtual ~ChMagneticFieldModel() = default;
+
+  /// Return the magnetic flux density [T] at the given position, expressed in the simulation frame.
+  virtual ChVector<> Get_Field(const ChVector<> &pos) const = 0;
+
+  /// Return a hash of the model parameters, used to validate cached field grids.
+  virtual uint64_t Get_Hash() const = 0;
+};
+
+/// Spherical harmonic (IGRF/WMM style) geomagnetic field model.
+/// The simulation frame is mapped onto a local East-North-Up frame tangent to a spherical earth at the
+/// given origin, so X points east, Y north and Z up.
+class CH_VEHICLE_API ChMagneticFieldSH : public ChMagneticFieldModel {
+ public:
+  /// Construct a centered dipole model using the IGRF-13 (2020) degree 1 coefficients.
+  ChMagneticFieldSH();
+
+  /// Set the geocentric latitude, longitude [deg] and altitude [m] of the simulation frame origin.
+  void Set_Origin(const double latitude, const double longitude, const double altitude);
+
+  /// Set the maximum degree of the expansion; the coefficients are reset to zero.
+  void Set_Degree(const int degree);
+
+  int Get_Degree() const { return m_degree; }
+
+  /// Set the Schmidt semi-normalized Gauss coefficients g_n^m, h_n^m [nT].
+  void Set_Coefficient(const int n, const int m, const double g, const double h);
+
+  /// Load the Gauss coefficients from a WMM.COF style file (lines of: n m g h [gdot hdot]).
+  bool Load(const std::string &filename);
+
+  ChVector<> Get_Field(const ChVector<> &pos) const override;
+
+  uint64_t Get_Hash() const override;
+
+ private:
+  size_t Index(const int n, const int m) const { return static_cast<size_t>(n * (n + 1) / 2 + m); }
+
+  int m_degree;
+  std::vector<double> m_g;
+  std::vector<double> m_h;
+  double m_latitude;
+  double m_longitude;
+  double m_altitude;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHMAGNETICFIELDMODEL_H
@@ -24,42 +24,168 @@
 #ifndef CHRONO_SENSOR_CHSENSOR_H
 #define CHRONO_SENSOR_CHSENSOR_H
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
 #include "chrono_vehicle/ChVehicle.h"
 #include "chrono_sensor/ChFunction_Sensor.h"
+#include "chrono_sensor/ChSensorBuffer.h"
+#include "chrono_sensor/ChSensorChannel.h"
+#include "chrono_sensor/ChSensorCsvWriter.h"
+#include "chrono_sensor/ChSensorDropout.h"
+#include "chrono_sensor/ChSensorHistory.h"
+#include "chrono_sensor/ChSensorInterpolation.h"
+#include "chrono_sensor/ChSensorLatency.h"
+#include "chrono_sensor/ChSensorSeqLock.h"
+#include "chrono_sensor/ChSensorSnapshot.h"
+#include "chrono_sensor/ChSensorPipeline.h"
 
 namespace chrono {
 namespace vehicle {
 namespace sensor {
 
+/// Sampling of the sensor input within a simulation step.
+enum SampleMode {
+  SAMPLE_STEP,     ///< Use the input of the current step, at most one sample per step
+  SAMPLE_LINEAR,   ///< Interpolate the input linearly to every sample instant within the step
+  SAMPLE_HERMITE   ///< Cubic Hermite interpolation, with tangents estimated from the last steps
+};
+
+/// Selection of the steps recorded by ChSensor::Log().
+enum LogPolicy {
+  LOG_ALL,        ///< Record every call
+  LOG_ON_CHANGE,  ///< Record when the output moves by more than a deadband, with the length of each run
+  LOG_EVERY_NTH,  ///< Record every Nth call
+  LOG_RATE        ///< Record at a separate period [s]
+};
+
+/// Timestamped sensor sample.
+template<class T>
+struct ChSensorSample {
+  double time;     ///< Sample instant
+  double release;  ///< Instant the sample is released to the output, the sample instant plus its delay
+  T value;
+};
+
+/// Consistent copy of the sensor state published at the end of each Advance(), for readers on other threads.
+template<class T>
+struct ChSensorState {
+  double time;         ///< Simulation time of the step
+  double output_time;  ///< Release instant of the output
+  T input;
+  T output;
+  uint64_t version;    ///< Number of steps published so far, 0 before the first one
+};
+
 /// Base class for a vehicle sensor system.
 template<class T>
 class CH_VEHICLE_API ChSensor {
  public:
+  /// Callback invoked for each released sample, so consumers only run on new samples instead of polling the
+  /// output after every step. It is called from Advance(), after the output has been updated.
+  class OutputCallback {
+   public:
+    virtual ~OutputCallback() = default;
+
+    virtual void OnOutput(const ChSensorSample<T> &sample) = 0;
+  };
+
   ChSensor()
-      : m_sample_rate(0.),
-        m_delay(0.),
-        m_log_filename(""),
+      : m_vehicle(nullptr),
+        m_sample_rate(0.),
+        m_pipeline_valid(false),
+        m_streaming(0),
+        m_optimize(true),
+        m_time(0.),
         m_prev_sample_time(0.),
-        m_prev_delay_time{0.},
+        m_delay(0.),
+        m_output_time(0.),
         m_sample(true),
-        m_write(true) {}
+        m_sample_mode(SAMPLE_STEP),
+        m_delivery(DELIVER_IN_ORDER),
+        m_dispatching(false),
+        m_log_policy(LOG_ALL),
+        m_log_parameter(0.),
+        m_log_calls(0),
+        m_log_run(0),
+        m_log_next(0.),
+        m_log_time(0.),
+        m_history_horizon(0.),
+        m_last_release(0.),
+        m_dropped(0),
+        m_prev_time(0.),
+        m_prev_prev_time(0.),
+        m_sample_origin(0.),
+        m_steps(0),
+        m_sample_index(0) {}
 
   ChSensor(ChVehicle &vehicle, double sample_rate = 0., double delay = 0.)
-      : m_vehicle(vehicle),
+      : m_vehicle(&vehicle),
         m_sample_rate(sample_rate),
-        m_delay(delay),
-        m_log_filename(""),
+        m_pipeline_valid(false),
+        m_streaming(0),
+        m_optimize(true),
+        m_time(0.),
         m_prev_sample_time(0.),
-        m_prev_delay_time{delay},
+        m_delay(delay),
+        m_output_time(0.),
         m_sample(true),
-        m_write(true) {};
+        m_sample_mode(SAMPLE_STEP),
+        m_delivery(DELIVER_IN_ORDER),
+        m_dispatching(false),
+        m_log_policy(LOG_ALL),
+        m_log_parameter(0.),
+        m_log_calls(0),
+        m_log_run(0),
+        m_log_next(0.),
+        m_log_time(0.),
+        m_history_horizon(0.),
+        m_last_release(0.),
+        m_dropped(0),
+        m_prev_time(0.),
+        m_prev_prev_time(0.),
+        m_sample_origin(0.),
+        m_steps(0),
+        m_sample_index(0) {};
+
+  virtual ~ChSensor() { LogFlush(); }
 
-  virtual ~ChSensor() = default;
+  /// Initialize this Sensor System. This compiles the transform chain into the pipeline evaluated by Advance(),
+  /// so transform parameters changed afterwards only take effect after the next Initialize(). Transforms added
+  /// afterwards trigger a new compilation on the next Advance().
+  virtual void Initialize() {
+    if (m_optimize) {
+      Compile_Pipeline(m_transform, m_fused, m_pipeline);
+    } else {
+      m_fused.clear();
+      m_pipeline.clear();
+      m_pipeline.reserve(m_transform.size());
+      for (auto &transform : m_transform) {
+        m_pipeline.push_back(transform.get());
+      }
+    }
+    m_streaming = 0;
+    for (size_t i = 0; i < m_pipeline.size(); ++i) {
+      if (m_pipeline[i]->Is_Streaming())
+        m_streaming = i + 1;
+    }
+    m_pipeline_valid = true;
 
-  /// Initialize this Sensor System
-  virtual void Initialize() {};
+    // Queue depths for the delay line at the nominal rate, the buffers only grow beyond this on rate jitter
+    size_t depth = m_sample_rate > 0. ? static_cast<size_t>(std::ceil(m_delay / m_sample_rate)) + 2 : 2;
+    m_aquired.Reserve(depth);
+    m_released.reserve(depth);
+    if (m_latency) {
+      m_pending.reserve(depth);
+    }
+    if (m_history_horizon > 0. && m_sample_rate > 0.) {
+      m_output_history.Reserve(static_cast<size_t>(std::ceil(m_history_horizon / m_sample_rate)) + 2);
+    }
+  };
 
-  ChVehicle &Get_Vehicle() const { return m_vehicle; }
+  ChVehicle &Get_Vehicle() const { return *m_vehicle; }
 
   void Set_Vehicle(ChVehicle &Vehicle) { m_vehicle = &Vehicle; }
 
@@ -67,6 +193,10 @@ class CH_VEHICLE_API ChSensor {
 
   void Set_SampleRate(double SampleRate) { m_sample_rate = SampleRate; }
 
+  double Get_Delay() const { return m_delay; }
+
+  void Set_Delay(double Delay) { m_delay = Delay; }
+
   void Set_Input(T input) { m_input = input; };
 
   T &Get_Input() { return m_input; };
@@ -75,81 +205,606 @@ class CH_VEHICLE_API ChSensor {
 
   T &Get_Output() { return m_output; };
 
+  /// Set a random latency added to the fixed delay of each sample, or nullptr for the fixed delay only.
+  void Set_Latency(std::shared_ptr<ChSensorLatency> Latency) { m_latency = Latency; }
+
+  std::shared_ptr<ChSensorLatency> Get_Latency() const { return m_latency; }
+
+  /// Set a dropout model deciding which samples are lost, or nullptr to deliver every sample.
+  void Set_Dropout(std::shared_ptr<ChSensorDropout> Dropout) { m_dropout = Dropout; }
+
+  std::shared_ptr<ChSensorDropout> Get_Dropout() const { return m_dropout; }
+
+  /// Return the number of samples lost by the dropout model.
+  size_t Get_DroppedCount() const { return m_dropped; }
+
+  /// Register a callback invoked for each released sample. A callback added from within a callback receives the
+  /// samples released after the current one.
+  void Add_OutputCallback(std::shared_ptr<OutputCallback> callback) { m_callbacks.push_back(callback); }
+
+  /// Unregister a callback. It may be called from within a callback, including on itself.
+  void Remove_OutputCallback(const std::shared_ptr<OutputCallback> &callback) {
+    if (m_dispatching) {
+      // Keep the positions of the callbacks being iterated, the entries are erased after the sample is dispatched
+      std::replace(m_callbacks.begin(), m_callbacks.end(), callback, std::shared_ptr<OutputCallback>());
+    } else {
+      m_callbacks.erase(std::remove(m_callbacks.begin(), m_callbacks.end(), callback), m_callbacks.end());
+    }
+  }
+
+  /// Register a channel receiving each released sample, to be drained by a consumer on another thread. The
+  /// simulation thread never blocks on it; samples are dropped when the consumer falls behind a full channel.
+  void Add_OutputChannel(std::shared_ptr<ChSensorChannel<ChSensorSample<T>>> channel) {
+    m_channels.push_back(channel);
+  }
+
+  void Remove_OutputChannel(const std::shared_ptr<ChSensorChannel<ChSensorSample<T>>> &channel) {
+    m_channels.erase(std::remove(m_channels.begin(), m_channels.end(), channel), m_channels.end());
+  }
+
+  DeliveryPolicy Get_DeliveryPolicy() const { return m_delivery; }
+
+  /// Set whether samples with random latencies may overtake each other (in order by default).
+  void Set_DeliveryPolicy(DeliveryPolicy DeliveryPolicy) { m_delivery = DeliveryPolicy; }
+
+  /// Return the instant the current output was released, i.e. its sample instant plus its delay.
+  double Get_OutputTime() const { return m_output_time; };
+
+  /// Append a transform to the chain applied to each sample.
+  void Add_Transform(std::shared_ptr<ChFunction_Sensor<T>> transform) {
+    m_transform.push_back(transform);
+    m_pipeline_valid = false;
+  }
+
+  const std::vector<std::shared_ptr<ChFunction_Sensor<T>>> &Get_Transforms() const { return m_transform; }
+
+  /// Enable or disable folding of the transform chain by Initialize() (enabled by default).
+  void Set_OptimizePipeline(bool OptimizePipeline) {
+    m_optimize = OptimizePipeline;
+    m_pipeline_valid = false;
+  }
+
+  /// Return the compiled transform pipeline.
+  const std::vector<ChFunction_Sensor<T> *> &Get_Pipeline() const { return m_pipeline; }
+
+  /// Return a description of the compiled transform pipeline, for debugging.
+  std::string Get_PipelineDescription() const { return Describe_Pipeline(m_pipeline); }
+
+  SampleMode Get_SampleMode() const { return m_sample_mode; }
+
+  /// Set how the input is sampled. SAMPLE_STEP samples the input of the first step at or after each nominal
+  /// sample instant. The interpolating modes sample exactly at the nominal instants, interpolating between the
+  /// previous and current step input, so they produce every sample whose instant falls within a step and allow
+  /// coarse integration steps or sample rates above the step rate.
+  void Set_SampleMode(SampleMode SampleMode) { m_sample_mode = SampleMode; }
+
+  /// Return a consistent copy of the time, input and output published by the last Advance(). It can be called from
+  /// any thread while the simulation runs, without ever blocking the simulation thread, unlike Get_Input() and
+  /// Get_Output() which may only be used from the simulation thread.
+  ChSensorState<T> Get_State() const {
+    double values[STATE_SIZE];
+    ChSensorState<T> state;
+    state.version = m_state.Read(values);
+    state.time = values[0];
+    state.output_time = values[1];
+    for (size_t i = 0; i < DIM; ++i) {
+      Component(state.input, i) = values[2 + i];
+      Component(state.output, i) = values[2 + DIM + i];
+    }
+    return state;
+  }
+
+  /// Keep the inputs and released outputs of the given time horizon [s] (0 disables the histories).
+  void Set_HistoryHorizon(double HistoryHorizon) {
+    m_history_horizon = HistoryHorizon;
+    m_input_history.Set_Horizon(HistoryHorizon);
+    m_output_history.Set_Horizon(HistoryHorizon);
+  }
+
+  double Get_HistoryHorizon() const { return m_history_horizon; }
+
+  /// Return the history of the step inputs, by step time.
+  const ChSensorHistory<T> &Get_InputHistory() const { return m_input_history; }
+
+  /// Return the history of the released outputs, by sample instant, e.g. to look up the measurement taken at a
+  /// given time.
+  const ChSensorHistory<T> &Get_OutputHistory() const { return m_output_history; }
+
+  /// Return the samples released during the last Advance(), oldest first.
+  const std::vector<ChSensorSample<T>> &Get_Released() const { return m_released; };
+
   /// Update the state of this driver system at the current time.
   virtual void Synchronize(double time) {
+    m_time = time;
+    if (m_sample_mode != SAMPLE_STEP)
+      return;
     update_time(time, m_prev_sample_time, m_sample_rate, m_sample);
-    auto dt = time - m_prev_delay_time[0];
-    if (dt >= m_sample_rate) {
-      m_write = true;
-      m_prev_delay_time.push_back(time);
-    } else {
-      m_write = false;
-    }
   };
 
   /// Advance the state of this driver system by the specified time step
   virtual void Advance(double step) {
-    if (m_sample) {
-      auto aquired = m_input;
-      for (auto transform : m_transform) {
-        aquired = transform->Get_y(aquired);
+    if (!m_pipeline_valid)
+      ChSensor<T>::Initialize();
+    if (m_history_horizon > 0.) {
+      // The step is only known here, make room for the inputs of the horizon before the history fills up
+      if (step > 0.)
+        m_input_history.Reserve(static_cast<size_t>(std::ceil(m_history_horizon / step)) + 2);
+      m_input_history.Push(m_time, m_input);
+    }
+
+    // The stages up to the last streaming transform run on every step, so each streaming transform is fed the
+    // output of the stage before it. The last streaming transform is only evaluated on the steps that are sampled
+    // and the remaining stages only run on the samples.
+    auto head = m_input;
+    for (size_t i = 0; i < m_streaming; ++i) {
+      m_pipeline[i]->Update(m_time);
+      if (m_pipeline[i]->Is_Streaming())
+        m_pipeline[i]->Push(head);
+      if (i + 1 < m_streaming)
+        head = m_pipeline[i]->Get_y(head);
+    }
+    m_released.clear();
+    if (m_sample_mode != SAMPLE_STEP) {
+      Oversample(head);
+    } else if (m_sample) {
+      if (m_streaming > 0)
+        head = m_pipeline[m_streaming - 1]->Get_y(head);
+      for (size_t i = m_streaming; i < m_pipeline.size(); ++i) {
+        m_pipeline[i]->Update(m_time);
+        head = m_pipeline[i]->Get_y(head);
       }
-      m_aquired.push_back(aquired);
+      Acquire(m_time, head);
+    }
+    Release();
+    Publish();
+  }
+
+  /// Write the complete sensor state to a binary snapshot: timers, input history, queued samples and the state of
+  /// every transform, fused stage, latency and dropout model (including their random generators), so a simulation
+  /// restored from it continues bit exactly. Callbacks, channels, histories and the log file are not part of the
+  /// state.
+  virtual void SnapshotOut(ChSensorSnapshot &snapshot) const {
+    snapshot.Write(SNAPSHOT_VERSION);
+    snapshot.Write(m_sample_rate);
+    snapshot.Write(m_delay);
+    snapshot.Write(m_input);
+    snapshot.Write(m_output);
+    snapshot.Write(m_time);
+    snapshot.Write(m_prev_sample_time);
+    snapshot.Write(m_output_time);
+    snapshot.Write(m_sample);
+    snapshot.Write(m_sample_mode);
+    snapshot.Write(m_delivery);
+    snapshot.Write(m_last_release);
+    snapshot.Write(static_cast<uint64_t>(m_dropped));
+    snapshot.Write(m_prev_input);
+    snapshot.Write(m_prev_prev_input);
+    snapshot.Write(m_prev_time);
+    snapshot.Write(m_prev_prev_time);
+    snapshot.Write(m_sample_origin);
+    snapshot.Write(static_cast<uint64_t>(m_steps));
+    snapshot.Write(static_cast<uint64_t>(m_sample_index));
+
+    snapshot.Write(static_cast<uint64_t>(m_aquired.Size()));
+    for (size_t i = 0; i < m_aquired.Size(); ++i) {
+      Write_Sample(snapshot, m_aquired[i]);
     }
-    if (m_write) {
-      m_output = m_aquired[0];
-      m_aquired.erase(m_aquired.begin());
-      m_prev_delay_time.erase(m_prev_delay_time.begin());
+    snapshot.Write(static_cast<uint64_t>(m_pending.size()));
+    for (const auto &sample : m_pending) {
+      Write_Sample(snapshot, sample);
     }
+
+    snapshot.Write(m_pipeline_valid);
+    for (const auto *stages : {&m_transform, &m_fused}) {
+      snapshot.Write(static_cast<uint64_t>(stages->size()));
+      for (const auto &stage : *stages) {
+        snapshot.Write(stage->Get_Type());
+        stage->SnapshotOut(snapshot);
+      }
+    }
+    snapshot.Write(static_cast<bool>(m_latency));
+    if (m_latency)
+      m_latency->SnapshotOut(snapshot);
+    snapshot.Write(static_cast<bool>(m_dropout));
+    if (m_dropout)
+      m_dropout->SnapshotOut(snapshot);
   }
 
-  /// Initialize output file for recording sensor inputs.
-  bool LogInit(const std::string &filename) {
-    m_log_filename = filename;
+  /// Restore a snapshot written by SnapshotOut(). The sensor must have been set up with the same transforms (and
+  /// latency and dropout models); returns false if they don't match or the snapshot is truncated.
+  virtual bool SnapshotIn(ChSensorSnapshot &snapshot) {
+    int version;
+    uint64_t dropped, steps, sample_index, size;
+    if (!(snapshot.Read(version) && version == SNAPSHOT_VERSION && snapshot.Read(m_sample_rate)
+        && snapshot.Read(m_delay) && snapshot.Read(m_input) && snapshot.Read(m_output) && snapshot.Read(m_time)
+        && snapshot.Read(m_prev_sample_time) && snapshot.Read(m_output_time) && snapshot.Read(m_sample)
+        && snapshot.Read(m_sample_mode) && snapshot.Read(m_delivery) && snapshot.Read(m_last_release)
+        && snapshot.Read(dropped) && snapshot.Read(m_prev_input) && snapshot.Read(m_prev_prev_input)
+        && snapshot.Read(m_prev_time) && snapshot.Read(m_prev_prev_time) && snapshot.Read(m_sample_origin)
+        && snapshot.Read(steps) && snapshot.Read(sample_index)))
+      return false;
+    m_dropped = dropped;
+    m_steps = steps;
+    m_sample_index = sample_index;
 
-    std::ofstream ofile(filename.c_str(), std::ios::out);
-    if (!ofile)
+    ChSensorSample<T> sample;
+    m_aquired.Clear();
+    if (!snapshot.Read(size))
       return false;
+    for (uint64_t i = 0; i < size; ++i) {
+      if (!Read_Sample(snapshot, sample))
+        return false;
+      m_aquired.Push(sample);
+    }
+    m_pending.clear();
+    if (!snapshot.Read(size))
+      return false;
+    for (uint64_t i = 0; i < size; ++i) {
+      if (!Read_Sample(snapshot, sample))
+        return false;
+      m_pending.push_back(sample);
+    }
+    m_released.clear();
 
-    ofile << "Time, Input, Output" << std::endl;
-    ofile.close();
-    return true;
+    // The fused stages only exist once the chain is compiled
+    bool pipeline_valid;
+    if (!snapshot.Read(pipeline_valid))
+      return false;
+    if (pipeline_valid) {
+      ChSensor<T>::Initialize();
+    } else {
+      m_pipeline_valid = false;
+      m_fused.clear();
+    }
+    for (auto *stages : {&m_transform, &m_fused}) {
+      FunctionType type;
+      if (!snapshot.Read(size) || size != stages->size())
+        return false;
+      for (auto &stage : *stages) {
+        if (!snapshot.Read(type) || type != stage->Get_Type() || !stage->SnapshotIn(snapshot))
+          return false;
+      }
+    }
+    bool latency, dropout;
+    if (!snapshot.Read(latency) || latency != static_cast<bool>(m_latency)
+        || (latency && !m_latency->SnapshotIn(snapshot)))
+      return false;
+    return snapshot.Read(dropout) && dropout == static_cast<bool>(m_dropout)
+        && (!dropout || m_dropout->SnapshotIn(snapshot));
+  }
+
+  /// Select the steps recorded by Log(), before LogInit(). The parameter is the deadband in counts for
+  /// LOG_ON_CHANGE, N for LOG_EVERY_NTH and the period [s] for LOG_RATE.
+  /// With LOG_ON_CHANGE a line is kept until the output moves by more than the deadband, and then written with the
+  /// number of Log() calls it stands for in an extra Count column. A count is the resolution of the last digitizer
+  /// at LogInit(); without one the deadband is in output units. A deadband of 0 records every change, so the logged
+  /// signal is reconstructed exactly from the runs.
+  void Set_LogPolicy(LogPolicy policy, double parameter = 0.) {
+    m_log_policy = policy;
+    m_log_parameter = parameter;
+  }
+
+  LogPolicy Get_LogPolicy() const { return m_log_policy; }
+
+  double Get_LogParameter() const { return m_log_parameter; }
+
+  /// Initialize output file for recording sensor inputs.
+  bool LogInit(const std::string &filename) {
+    LogFlush();
+    if (!m_log.Open(filename))
+      return false;
+    m_log_calls = 0;
+    m_log_run = 0;
+    std::fill(m_log_count, m_log_count + DIM, 0.);
+    for (auto &transform : m_transform) {
+      if (auto digitize = std::dynamic_pointer_cast<ChFunction_SensorDigitize<T>>(transform)) {
+        if (digitize->Get_Bits() > 0.) {
+          // Quaternions digitize the vector part
+          const auto &resolution = digitize->Get_Resolution();
+          if constexpr(std::is_same<T, double>::value) {
+            m_log_count[0] = resolution;
+          } else {
+            for (size_t i = 0; i < 3; ++i) {
+              m_log_count[DIM - 3 + i] = resolution[i];
+            }
+          }
+        }
+      }
+    }
+    m_log.Write("Time").Write("Input").Write("Output");
+    if (m_log_policy == LOG_ON_CHANGE)
+      m_log.Write("Count");
+    return m_log.End_Line();
   };
 
-  /// Record the current sensor inputs to the log file.
+  /// Record the current sensor inputs to the log file, as selected by the log policy. Lines are buffered and
+  /// written in blocks, see LogFlush().
   bool Log(double time) {
-    if (m_log_filename.empty())
+    if (!m_log.Is_Open())
       return false;
+    switch (m_log_policy) {
+      case LOG_ALL:break;
+      case LOG_ON_CHANGE:
+        if (m_log_run > 0 && !Log_Changed()) {
+          ++m_log_run;
+          return true;
+        }
+        if (!Log_Run())
+          return false;
+        m_log_time = time;
+        m_log_input = m_input;
+        m_log_output = m_output;
+        m_log_run = 1;
+        return true;
+      case LOG_EVERY_NTH:
+        if (m_log_calls++ % std::max<size_t>(1, static_cast<size_t>(m_log_parameter)) != 0)
+          return true;
+        break;
+      case LOG_RATE:
+        if (m_log_calls > 0 && time < m_log_next - 1e-9 * m_log_parameter)
+          return true;
+        // The next instant stays on the grid of the first one, skipping the instants missed in a gap
+        m_log_next = m_log_calls++ == 0 ? time + m_log_parameter
+            : m_log_next + m_log_parameter * (std::floor((time - m_log_next) / m_log_parameter + 1e-9) + 1.);
+        break;
+    }
+    m_log.Write(time).Write(m_input).Write(m_output);
+    return m_log.End_Line();
+  }
 
-    std::ofstream ofile(m_log_filename.c_str(), std::ios::app);
-    if (!ofile)
-      return false;
+  /// Write the buffered log lines to the file, e.g. before reading it during the run. This ends the current run of
+  /// LOG_ON_CHANGE. The log is also written when the sensor is destroyed.
+  bool LogFlush() { return Log_Run() && m_log.Flush(); }
 
-    ofile << time << ", " << m_input << ", " << m_output << std::endl;
-    ofile.close();
-    return true;
-  }
+  /// Access the log writer, e.g. to change its precision or flush thresholds.
+  ChSensorCsvWriter &Get_LogWriter() { return m_log; }
 
  protected:
-  ChVehicle &m_vehicle;
+  ChVehicle *m_vehicle;
   double m_sample_rate;
   T m_input;
-  std::vector<T> m_aquired;
+  ChSensorBuffer<ChSensorSample<T>> m_aquired;
   T m_output;
   std::vector<std::shared_ptr<ChFunction_Sensor<T>>> m_transform;
+  std::vector<ChFunction_Sensor<T> *> m_pipeline;  ///< Transform chain compiled by Initialize()
+  std::vector<std::shared_ptr<ChFunction_Sensor<T>>> m_fused;  ///< Stages created by folding the chain
+  bool m_pipeline_valid;
+  size_t m_streaming;  ///< Number of leading pipeline stages run on every step, up to the last streaming one
+  bool m_optimize;
+  std::vector<ChSensorSample<T>> m_released;
+  double m_time;
   double m_prev_sample_time;
-  std::vector<double> m_prev_delay_time;
   double m_delay;
+  double m_output_time;
   bool m_sample;
-  bool m_write;
+  SampleMode m_sample_mode;
+  std::shared_ptr<ChSensorLatency> m_latency;
+  std::shared_ptr<ChSensorDropout> m_dropout;
+  DeliveryPolicy m_delivery;
+  std::vector<std::shared_ptr<OutputCallback>> m_callbacks;
+  bool m_dispatching;  ///< True while the callbacks are invoked
+  std::vector<std::shared_ptr<ChSensorChannel<ChSensorSample<T>>>> m_channels;
 
  private:
-  std::string m_log_filename;
+  /// Generate every sample with an instant within (previous step, current step] by interpolating the output of the
+  /// streaming stages (the input if there are none), run them through the remaining transforms as a batch and
+  /// release the ones whose delay has passed. The head is the input of the last streaming stage, which is only
+  /// evaluated, along with its outputs of the previous steps, when a sample falls within the step.
+  void Oversample(const T &head) {
+    if (m_steps == 0) {
+      m_sample_origin = m_time;
+      m_sample_index = 0;
+    }
+
+    m_batch.clear();
+    m_batch_time.clear();
+    double h = m_time - m_prev_time;
+    T current = head;
+    bool evaluated = m_streaming == 0;
+    while (true) {
+      double t = m_sample_rate > 0. ? m_sample_origin + m_sample_index * m_sample_rate : m_time;
+      if (t > m_time + 1e-9 * std::max(m_sample_rate, h) || (m_sample_rate <= 0. && !m_batch.empty()))
+        break;
+      if (!evaluated) {
+        const ChFunction_Sensor<T> *stage = m_pipeline[m_streaming - 1];
+        current = stage->Get_y(head);
+        if (m_steps > 0)
+          m_prev_input = stage->Get_y_Delayed(head, 1);
+        if (m_sample_mode == SAMPLE_HERMITE && m_steps > 1)
+          m_prev_prev_input = stage->Get_y_Delayed(head, 2);
+        evaluated = true;
+      }
+      double s = h > 0. ? std::min(std::max((t - m_prev_time) / h, 0.), 1.) : 1.;
+      if (m_steps == 0 || s == 1.) {
+        m_batch.push_back(current);
+      } else if (m_sample_mode == SAMPLE_HERMITE && m_steps > 1) {
+        T d_prev = (current - m_prev_prev_input) * (1. / (m_time - m_prev_prev_time));
+        T d_cur = (current - m_prev_input) * (1. / h);
+        m_batch.push_back(Interpolate_Hermite(m_prev_input, d_prev, current, d_cur, h, s));
+      } else {
+        m_batch.push_back(Interpolate_Linear(m_prev_input, current, s));
+      }
+      m_batch_time.push_back(t);
+      ++m_sample_index;
+    }
+
+    // Transform major order, so each transform processes the whole batch at once
+    for (size_t i = m_streaming; i < m_pipeline.size(); ++i) {
+      for (size_t k = 0; k < m_batch.size(); ++k) {
+        m_pipeline[i]->Update(m_batch_time[k]);
+        m_batch[k] = m_pipeline[i]->Get_y(m_batch[k]);
+      }
+    }
+    for (size_t k = 0; k < m_batch.size(); ++k) {
+      Acquire(m_batch_time[k], m_batch[k]);
+    }
+
+    m_prev_prev_input = m_prev_input;
+    m_prev_prev_time = m_prev_time;
+    m_prev_input = current;
+    m_prev_time = m_time;
+    ++m_steps;
+  }
+
+  /// Queue a processed sample for release after its delay, unless it is lost. Release instants are non decreasing
+  /// for a fixed delay or in order delivery, so those samples go through the FIFO; reordering samples are kept in a
+  /// min-heap.
+  void Acquire(double time, const T &value) {
+    if (m_dropout && m_dropout->Is_Dropped()) {
+      ++m_dropped;
+      return;
+    }
+    double release = time + m_delay;
+    if (!m_latency) {
+      m_aquired.Push({time, release, value});
+      return;
+    }
+    release += m_latency->Get_Latency();
+    if (m_delivery == DELIVER_IN_ORDER) {
+      release = std::max(release, m_last_release);
+      m_last_release = release;
+      m_aquired.Push({time, release, value});
+    } else {
+      m_pending.push_back({time, release, value});
+      std::push_heap(m_pending.begin(), m_pending.end(), Later);
+    }
+  }
+
+  /// Release the acquired samples whose release instant has been reached. The output holds the latest one.
+  void Release() {
+    while (!m_aquired.Empty() && m_aquired.Front().release <= m_time + 1e-12) {
+      Deliver(m_aquired.Front());
+      m_aquired.Pop();
+    }
+    while (!m_pending.empty() && m_pending.front().release <= m_time + 1e-12) {
+      std::pop_heap(m_pending.begin(), m_pending.end(), Later);
+      Deliver(m_pending.back());
+      m_pending.pop_back();
+    }
+  }
+
+  static void Write_Sample(ChSensorSnapshot &snapshot, const ChSensorSample<T> &sample) {
+    snapshot.Write(sample.time);
+    snapshot.Write(sample.release);
+    snapshot.Write(sample.value);
+  }
+
+  static bool Read_Sample(ChSensorSnapshot &snapshot, ChSensorSample<T> &sample) {
+    return snapshot.Read(sample.time) && snapshot.Read(sample.release) && snapshot.Read(sample.value);
+  }
+
+  static constexpr int SNAPSHOT_VERSION = 1;
+
+  static constexpr size_t DIM = std::is_same<T, double>::value ? 1 : (std::is_same<T, ChVector<>>::value ? 3 : 4);
+  static constexpr size_t STATE_SIZE = 2 + 2 * DIM;
+
+  static double &Component(T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static double Component(const T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  /// Whether the output moved by more than the deadband since the logged run started.
+  bool Log_Changed() const {
+    for (size_t i = 0; i < DIM; ++i) {
+      double change = std::abs(Component(m_output, i) - Component(m_log_output, i));
+      if (m_log_count[i] > 0.)
+        change = std::round(change / m_log_count[i]);
+      if (change > m_log_parameter)
+        return true;
+    }
+    return false;
+  }
+
+  /// Write the pending run of LOG_ON_CHANGE.
+  bool Log_Run() {
+    if (m_log_run == 0)
+      return true;
+    m_log.Write(m_log_time).Write(m_log_input).Write(m_log_output).Write(m_log_run);
+    m_log_run = 0;
+    return m_log.End_Line();
+  }
+
+  /// Publish the step state for Get_State().
+  void Publish() {
+    double values[STATE_SIZE];
+    values[0] = m_time;
+    values[1] = m_output_time;
+    for (size_t i = 0; i < DIM; ++i) {
+      values[2 + i] = Component(m_input, i);
+      values[2 + DIM + i] = Component(m_output, i);
+    }
+    m_state.Write(values);
+  }
+
+  void Deliver(const ChSensorSample<T> &sample) {
+    m_released.push_back(sample);
+    m_output = sample.value;
+    m_output_time = sample.release;
+    if (m_history_horizon > 0.)
+      m_output_history.Push(sample.time, sample.value);
+    // Iterate by index over the callbacks registered before this sample, each held by a copy, as callbacks may
+    // add or remove callbacks
+    m_dispatching = true;
+    for (size_t i = 0, n = m_callbacks.size(); i < n; ++i) {
+      if (auto callback = m_callbacks[i])
+        callback->OnOutput(sample);
+    }
+    m_dispatching = false;
+    m_callbacks.erase(std::remove(m_callbacks.begin(), m_callbacks.end(), nullptr), m_callbacks.end());
+    for (auto &channel : m_channels) {
+      channel->Push(sample);
+    }
+  }
+
+  /// Heap order of the pending samples: earliest release on top, ties in sample order.
+  static bool Later(const ChSensorSample<T> &a, const ChSensorSample<T> &b) {
+    return a.release > b.release || (a.release == b.release && a.time > b.time);
+  }
+
+  ChSensorCsvWriter m_log;
+  LogPolicy m_log_policy;
+  double m_log_parameter;
+  double m_log_count[DIM];  ///< Size of a count of each output component, 0 if not digitized
+  size_t m_log_calls;
+  size_t m_log_run;  ///< Number of Log() calls of the pending LOG_ON_CHANGE line
+  double m_log_next;
+  double m_log_time;
+  T m_log_input;
+  T m_log_output;
+  std::vector<ChSensorSample<T>> m_pending;  ///< Min-heap on the release instant of the reordering samples
+  double m_history_horizon;
+  ChSensorHistory<T> m_input_history;
+  ChSensorHistory<T> m_output_history;
+  ChSensorSeqLock<STATE_SIZE> m_state;
+  double m_last_release;
+  size_t m_dropped;
+  std::vector<T> m_batch;
+  std::vector<double> m_batch_time;
+  T m_prev_input;       ///< Interpolated value of the previous step, stale while a streaming stage isn't evaluated
+  T m_prev_prev_input;
+  double m_prev_time;
+  double m_prev_prev_time;
+  double m_sample_origin;
+  size_t m_steps;
+  size_t m_sample_index;
   void update_time(const double &time, double &prev_time, const double &condition, bool &set_condition) {
     double dt = time - prev_time;
-    if (dt >= condition) {
+    // Tolerate the round-off in the step times accumulated by the integrator
+    if (dt >= condition * (1. - 1e-9)) {
       set_condition = true;
-      prev_time = time;
+      // Stay on the nominal schedule, rather than drifting with the step times
+      prev_time = condition > 0. ? prev_time + condition * std::max(1., std::floor(dt / condition)) : time;
     } else {
       set_condition = false;
     }
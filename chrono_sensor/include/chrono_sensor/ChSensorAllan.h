@@ -0,0 +1,56 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORALLAN_H
+#define CHRONO_SENSOR_CHSENSORALLAN_H
+
+#include <cstddef>
+#include <vector>
+
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Allan deviation at one cluster time.
+struct ChAllanPoint {
+  double tau;        ///< Cluster time [s]
+  double deviation;  ///< Overlapping Allan deviation
+  size_t terms;      ///< Number of overlapping differences averaged
+};
+
+/// Overlapping Allan deviation of a rate signal (e.g. gyroscope or accelerometer output) sampled at the period
+/// tau0, over octave spaced cluster times subdivided into the given number of points per octave. The signal is
+/// integrated once into cumulative sums, so each cluster time costs one pass over the signal, spread over the
+/// OpenMP threads. Components of vector signals are read with the given stride, e.g. 3 for an array of ChVector<>.
+CH_VEHICLE_API std::vector<ChAllanPoint> Allan_Deviation(const double *rate, size_t count, double tau0,
+                                                         size_t points_per_octave = 1, size_t stride = 1);
+
+CH_VEHICLE_API std::vector<ChAllanPoint> Allan_Deviation(const std::vector<double> &rate, double tau0,
+                                                         size_t points_per_octave = 1);
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORALLAN_H
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORBUFFER_H
+#define CHRONO_SENSOR_CHSENSORBUFFER_H
+
+#include <vector>
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Circular FIFO buffer. Storage only grows (doubling) when the buffer is full, so once a sensor has reached its
+/// steady state queue depth, pushing and popping never allocate.
+template<class T>
+class ChSensorBuffer {
+ public:
+  ChSensorBuffer() : m_head(0), m_size(0) {}
+
+  explicit ChSensorBuffer(size_t capacity) : m_head(0), m_size(0) { Reserve(capacity); }
+
+  /// Make sure the buffer can hold at least the given number of elements without allocating.
+  void Reserve(size_t capacity) {
+    if (capacity <= m_data.size())
+      return;
+    size_t n = 1;
+    while (n < capacity)
+      n <<= 1;
+    std::vector<T> data(n);
+    for (size_t i = 0; i < m_size; ++i) {
+      data[i] = (*this)[i];
+    }
+    m_data.swap(data);
+    m_head = 0;
+  }
+
+  void Push(const T &value) {
+    if (m_size == m_data.size())
+      Reserve(m_size == 0 ? 8 : 2 * m_size);
+    m_data[(m_head + m_size) & (m_data.size() - 1)] = value;
+    ++m_size;
+  }
+
+  /// Remove the given number of elements from the front.
+  void Pop(size_t count = 1) {
+    m_head = (m_head + count) & (m_data.size() - 1);
+    m_size -= count;
+  }
+
+  T &Front() { return m_data[m_head]; }
+
+  const T &Front() const { return m_data[m_head]; }
+
+  T &operator[](size_t i) { return m_data[(m_head + i) & (m_data.size() - 1)]; }
+
+  const T &operator[](size_t i) const { return m_data[(m_head + i) & (m_data.size() - 1)]; }
+
+  size_t Size() const { return m_size; }
+
+  bool Empty() const { return m_size == 0; }
+
+  size_t Capacity() const { return m_data.size(); }
+
+  void Clear() {
+    m_head = 0;
+    m_size = 0;
+  }
+
+ private:
+  std::vector<T> m_data;
+  size_t m_head;
+  size_t m_size;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORBUFFER_H
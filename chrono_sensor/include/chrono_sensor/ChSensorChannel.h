@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORCHANNEL_H
+#define CHRONO_SENSOR_CHSENSORCHANNEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Wait free single producer, single consumer ring buffer, to hand sensor samples from the simulation thread to a
+/// consumer thread. The producer never blocks: pushing into a full channel drops the new element and counts an
+/// overflow. Each side keeps a cached copy of the other side's index, so the shared indices are only read when the
+/// cached one says the channel looks full (or empty).
+template<class T>
+class ChSensorChannel {
+ public:
+  /// Create a channel holding at least the given number of elements (rounded up to a power of two).
+  explicit ChSensorChannel(size_t capacity = 1024)
+      : m_head(0), m_tail(0), m_overflows(0), m_tail_cache(0), m_head_cache(0) {
+    size_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    m_data.resize(n);
+    m_mask = n - 1;
+  }
+
+  ChSensorChannel(const ChSensorChannel &) = delete;
+  ChSensorChannel &operator=(const ChSensorChannel &) = delete;
+
+  /// Producer side. Return false, dropping the value, if the channel is full.
+  bool Push(const T &value) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache > m_mask) {
+      m_head_cache = m_head.load(std::memory_order_acquire);
+      if (tail - m_head_cache > m_mask) {
+        m_overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    m_data[tail & m_mask] = value;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side. Return false if the channel is empty.
+  bool Pop(T &value) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache) {
+      m_tail_cache = m_tail.load(std::memory_order_acquire);
+      if (head == m_tail_cache)
+        return false;
+    }
+    value = m_data[head & m_mask];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer side. Move up to max_count elements to values, oldest first, and return their number.
+  size_t Pop(T *values, size_t max_count) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    m_tail_cache = m_tail.load(std::memory_order_acquire);
+    size_t count = std::min(m_tail_cache - head, max_count);
+    for (size_t i = 0; i < count; ++i) {
+      values[i] = m_data[(head + i) & m_mask];
+    }
+    m_head.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /// Number of elements in the channel; only a snapshot when the other side is running.
+  size_t Size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return m_data.size(); }
+
+  /// Number of elements dropped because the channel was full.
+  size_t Get_Overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+
+ private:
+  std::vector<T> m_data;
+  size_t m_mask;
+  alignas(64) std::atomic<size_t> m_head;  ///< Next element to pop, written by the consumer
+  alignas(64) std::atomic<size_t> m_tail;  ///< Next element to push, written by the producer
+  std::atomic<size_t> m_overflows;
+  alignas(64) size_t m_tail_cache;  ///< Consumer's copy of the tail
+  alignas(64) size_t m_head_cache;  ///< Producer's copy of the head
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORCHANNEL_H
@@ -0,0 +1,118 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORCSVWRITER_H
+#define CHRONO_SENSOR_CHSENSORCSVWRITER_H
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "chrono/core/ChQuaternion.h"
+#include "chrono/core/ChVector.h"
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Buffered CSV writer for sensor logs. Fields are formatted with std::to_chars into a reusable buffer, which is
+/// independent of the locale and does not allocate, and written to the file in blocks when the buffer exceeds the
+/// block size or when the flush interval has passed at the end of a line. The default precision gives the same
+/// text as the stream operators, including the two spaces between the components of vectors and quaternions.
+class CH_VEHICLE_API ChSensorCsvWriter {
+ public:
+  explicit ChSensorCsvWriter(size_t block_size = 1 << 16, double flush_interval = 1.);
+
+  ~ChSensorCsvWriter();
+
+  ChSensorCsvWriter(const ChSensorCsvWriter &) = delete;
+
+  ChSensorCsvWriter &operator=(const ChSensorCsvWriter &) = delete;
+
+  /// Open the file, truncated or appended to.
+  bool Open(const std::string &filename, bool append = false);
+
+  /// Flush and close the file.
+  void Close();
+
+  bool Is_Open() const { return m_file.is_open(); }
+
+  /// Significant digits of the values, or 0 for the shortest text that reads back to the same value. Clamped to
+  /// [0, 17], as 17 digits already identify every double.
+  void Set_Precision(int Precision);
+
+  int Get_Precision() const { return m_precision; }
+
+  /// Separator written between the fields of a line.
+  void Set_Delimiter(const std::string &Delimiter) { m_delimiter = Delimiter; }
+
+  const std::string &Get_Delimiter() const { return m_delimiter; }
+
+  /// Block size [bytes] and wall clock interval [s] after which the buffer is written to the file.
+  void Set_Flush(size_t block_size, double flush_interval);
+
+  /// Append a field to the current line.
+  ChSensorCsvWriter &Write(double value);
+
+  ChSensorCsvWriter &Write(size_t value);
+
+  ChSensorCsvWriter &Write(const ChVector<> &value);
+
+  ChSensorCsvWriter &Write(const ChQuaternion<> &value);
+
+  ChSensorCsvWriter &Write(const std::string &text);
+
+  /// End the current line and write the buffer to the file if a threshold is reached.
+  bool End_Line();
+
+  /// Write the buffer to the file.
+  bool Flush();
+
+  /// Number of bytes formatted since the file was opened.
+  size_t Get_BytesWritten() const { return m_bytes; }
+
+ private:
+  void Begin_Field();
+
+  void Append(double value);
+
+  void Append(const char *text, size_t length);
+
+  std::ofstream m_file;
+  std::vector<char> m_buffer;
+  size_t m_size;
+  size_t m_block_size;
+  double m_flush_interval;
+  std::chrono::steady_clock::time_point m_last_flush;
+  int m_precision;
+  std::string m_delimiter;
+  bool m_line_start;
+  size_t m_bytes;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORCSVWRITER_H
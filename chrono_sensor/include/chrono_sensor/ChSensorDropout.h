@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORDROPOUT_H
+#define CHRONO_SENSOR_CHSENSORDROPOUT_H
+
+#include <random>
+
+#include "chrono_vehicle/ChApiVehicle.h"
+#include "chrono_sensor/ChSensorSnapshot.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Sample dropout (packet loss) model, evaluated once per acquired sample.
+/// The default is a two state Gilbert-Elliott channel: in the good state samples are lost with probability
+/// loss_good, in the bad state with loss_bad, and the state switches with the given per-sample probabilities.
+/// A single state (independent Bernoulli losses) is the special case built by the one argument constructor.
+/// Derived classes may override Is_Dropped() to model other channels.
+class CH_VEHICLE_API ChSensorDropout {
+ public:
+  /// Independent losses with the given probability.
+  explicit ChSensorDropout(const double loss);
+
+  /// Bursty losses of a Gilbert-Elliott channel.
+  ChSensorDropout(const double p_good_bad, const double p_bad_good, const double loss_good, const double loss_bad);
+
+  virtual ~ChSensorDropout() = default;
+
+  /// Advance the channel by one sample and return whether the sample is lost.
+  virtual bool Is_Dropped();
+
+  /// Return the long run fraction of lost samples.
+  double Get_LossRate() const;
+
+  /// Write the channel parameters, state and random generator state to a binary snapshot.
+  virtual void SnapshotOut(ChSensorSnapshot &snapshot) const;
+
+  virtual bool SnapshotIn(ChSensorSnapshot &snapshot);
+
+  bool Is_Bad() const { return m_bad; }
+
+  /// Reseed the random generator, for reproducible runs.
+  void Set_Seed(const unsigned int seed) { m_gen.seed(seed); }
+
+ protected:
+  double m_p_good_bad;
+  double m_p_bad_good;
+  double m_loss_good;
+  double m_loss_bad;
+  bool m_bad;
+  std::default_random_engine m_gen;
+  std::uniform_real_distribution<double> m_uniform;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORDROPOUT_H
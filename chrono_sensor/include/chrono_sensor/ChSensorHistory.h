@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORHISTORY_H
+#define CHRONO_SENSOR_CHSENSORHISTORY_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "chrono_sensor/ChSensorBuffer.h"
+#include "chrono_sensor/ChSensorInterpolation.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Time indexed history of timestamped values over a sliding horizon. Values older than the horizon before the
+/// newest one are evicted, so the memory stays flat over arbitrarily long runs once the buffer has grown to the
+/// horizon. Lookups first try the index predicted from the average spacing, which is exact for values at a fixed
+/// rate, and fall back to a binary search.
+template<class T>
+class ChSensorHistory {
+ public:
+  struct Entry {
+    double time;
+    T value;
+  };
+
+  explicit ChSensorHistory(double horizon = 1.) : m_horizon(horizon) {}
+
+  double Get_Horizon() const { return m_horizon; }
+
+  void Set_Horizon(double Horizon) { m_horizon = Horizon; }
+
+  /// Make room for the given number of values without allocating.
+  void Reserve(size_t capacity) { m_data.Reserve(capacity); }
+
+  /// Add a value. Values normally arrive in time order; a late one is inserted at its place.
+  void Push(double time, const T &value) {
+    if (m_data.Empty() || time >= m_data[m_data.Size() - 1].time) {
+      m_data.Push({time, value});
+    } else {
+      Entry last = m_data[m_data.Size() - 1];
+      m_data.Push(last);
+      size_t i = m_data.Size() - 2;
+      while (i > 0 && m_data[i - 1].time > time) {
+        m_data[i] = m_data[i - 1];
+        --i;
+      }
+      m_data[i] = {time, value};
+    }
+    double oldest = m_data[m_data.Size() - 1].time - m_horizon;
+    size_t count = 0;
+    while (count < m_data.Size() - 1 && m_data[count].time < oldest)
+      ++count;
+    if (count > 0)
+      m_data.Pop(count);
+  }
+
+  /// Return the index of the last value at or before the given time, or -1 if there is none.
+  long Find(double time) const {
+    size_t n = m_data.Size();
+    if (n == 0 || time < m_data[0].time)
+      return -1;
+    if (time >= m_data[n - 1].time)
+      return static_cast<long>(n - 1);
+    // Direct index guess from the average spacing, checked against its neighbours
+    double span = m_data[n - 1].time - m_data[0].time;
+    auto guess = static_cast<size_t>((time - m_data[0].time) / span * (n - 1));
+    guess = std::min(guess, n - 2);
+    if (m_data[guess].time <= time && time < m_data[guess + 1].time)
+      return static_cast<long>(guess);
+    // Binary search for the first value after the time
+    size_t lo = 0;
+    size_t hi = n - 1;
+    while (hi - lo > 1) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (m_data[mid].time <= time)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    return static_cast<long>(lo);
+  }
+
+  /// Return the value at the given time, interpolated linearly between the neighbouring values (or the last
+  /// value at or before the time when not interpolating). Fails if the time is outside the history.
+  bool Get_Value(double time, T &value, bool interpolate = true) const {
+    long i = Find(time);
+    if (i < 0 || (interpolate && time > m_data[m_data.Size() - 1].time))
+      return false;
+    const Entry &a = m_data[i];
+    if (!interpolate || static_cast<size_t>(i) + 1 == m_data.Size() || time == a.time) {
+      value = a.value;
+    } else {
+      const Entry &b = m_data[i + 1];
+      value = Interpolate_Linear(a.value, b.value, (time - a.time) / (b.time - a.time));
+    }
+    return true;
+  }
+
+  /// Access the values, oldest first.
+  const Entry &operator[](size_t i) const { return m_data[i]; }
+
+  size_t Size() const { return m_data.Size(); }
+
+  bool Empty() const { return m_data.Empty(); }
+
+  double Get_OldestTime() const { return m_data.Empty() ? 0. : m_data[0].time; }
+
+  double Get_NewestTime() const { return m_data.Empty() ? 0. : m_data[m_data.Size() - 1].time; }
+
+  void Clear() { m_data.Clear(); }
+
+ private:
+  double m_horizon;
+  ChSensorBuffer<Entry> m_data;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORHISTORY_H
@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORINTERPOLATION_H
+#define CHRONO_SENSOR_CHSENSORINTERPOLATION_H
+
+#include <type_traits>
+
+#include "chrono/core/ChVector.h"
+#include "chrono/core/ChQuaternion.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Interpolate linearly between a and b, s in [0, 1]. Quaternions are normalized linearly interpolated
+/// along the shortest arc.
+template<typename T>
+T Interpolate_Linear(const T &a, const T &b, const double s) {
+  if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+    double dot = a.e0() * b.e0() + a.e1() * b.e1() + a.e2() * b.e2() + a.e3() * b.e3();
+    double sb = dot < 0. ? -s : s;
+    ChQuaternion<> q(a.e0() * (1. - s) + b.e0() * sb,
+                     a.e1() * (1. - s) + b.e1() * sb,
+                     a.e2() * (1. - s) + b.e2() * sb,
+                     a.e3() * (1. - s) + b.e3() * sb);
+    q.Normalize();
+    return q;
+  } else {
+    return a + (b - a) * s;
+  }
+}
+
+/// Cubic Hermite interpolation between a and b over an interval of length h, with the tangents (derivatives
+/// with respect to time) da and db, s in [0, 1]. Quaternions fall back to Interpolate_Linear.
+template<typename T>
+T Interpolate_Hermite(const T &a, const T &da, const T &b, const T &db, const double h, const double s) {
+  if constexpr(std::is_same<T, ChQuaternion<>>::value) {
+    return Interpolate_Linear(a, b, s);
+  } else {
+    double s2 = s * s;
+    double s3 = s2 * s;
+    double h00 = 2. * s3 - 3. * s2 + 1.;
+    double h10 = s3 - 2. * s2 + s;
+    double h01 = -2. * s3 + 3. * s2;
+    double h11 = s3 - s2;
+    return a * h00 + da * (h10 * h) + b * h01 + db * (h11 * h);
+  }
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORINTERPOLATION_H
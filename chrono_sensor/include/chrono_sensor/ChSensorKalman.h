@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORKALMAN_H
+#define CHRONO_SENSOR_CHSENSORKALMAN_H
+
+#include "chrono_sensor/ChSensorMatrix.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Covariance propagation and measurement update of an extended Kalman filter with N error states, on fixed size
+/// matrices. The nominal state and its models are kept by the estimator using it, which applies the corrections.
+template<int N>
+class ChSensorKalman {
+ public:
+  using State = ChSensorMatrix<N, 1>;
+  using Covariance = ChSensorMatrix<N, N>;
+
+  ChSensorKalman() : m_P(Covariance::Identity()) {}
+
+  const Covariance &Get_Covariance() const { return m_P; }
+
+  void Set_Covariance(const Covariance &P) { m_P = P; }
+
+  /// P = F P F^T + Q, for the state transition F and the process noise Q of a step.
+  void Predict(const Covariance &F, const Covariance &Q) {
+    m_P = F * m_P * F.Transpose() + Q;
+    m_P.Symmetrize();
+  }
+
+  /// Update with an M dimensional measurement residual z - h(x), its Jacobian H and noise covariance R, returning
+  /// the state correction. The covariance uses the Joseph form, which stays positive definite under rounding.
+  /// Fails, leaving the filter unchanged, if the innovation covariance is not positive definite.
+  template<int M>
+  bool Update(const ChSensorMatrix<M, 1> &residual, const ChSensorMatrix<M, N> &H, const ChSensorMatrix<M, M> &R,
+              State &correction) {
+    ChSensorMatrix<N, M> PHt = m_P * H.Transpose();
+    ChSensorMatrix<M, M> S = H * PHt + R;
+    // S K^T = (P H^T)^T, on a copy as the solve overwrites S with its factor
+    ChSensorMatrix<M, M> factor = S;
+    ChSensorMatrix<M, N> Kt = PHt.Transpose();
+    if (!ChSensorMatrix<M, M>::Solve_Spd(factor, Kt))
+      return false;
+    ChSensorMatrix<N, M> K = Kt.Transpose();
+    correction = K * residual;
+    // Joseph form, (I - K H) P (I - K H)^T + K R K^T, evaluated as products: a sum of positive semi-definite terms
+    Covariance A = Covariance::Identity() - K * H;
+    m_P = A * m_P * A.Transpose() + K * (R * Kt);
+    m_P.Symmetrize();
+    return true;
+  }
+
+ protected:
+  Covariance m_P;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORKALMAN_H
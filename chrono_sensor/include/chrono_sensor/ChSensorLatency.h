@@ -0,0 +1,81 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORLATENCY_H
+#define CHRONO_SENSOR_CHSENSORLATENCY_H
+
+#include <random>
+
+#include "chrono_vehicle/ChApiVehicle.h"
+#include "chrono_sensor/ChSensorSnapshot.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Distribution of the random latency added to each sample.
+enum LatencyDistribution {
+  LATENCY_UNIFORM,     ///< Uniform over [0, scale]
+  LATENCY_NORMAL,      ///< Half normal with the scale as standard deviation of the underlying normal
+  LATENCY_EXPONENTIAL  ///< Exponential with the scale as mean, e.g. queueing on a shared bus
+};
+
+/// Order in which samples with random latencies are delivered.
+enum DeliveryPolicy {
+  DELIVER_IN_ORDER,  ///< A sample is held until all earlier samples are delivered
+  DELIVER_REORDER    ///< Samples are delivered as soon as their latency has passed, possibly out of order
+};
+
+/// Random per-sample latency (jitter) model, added by a sensor to its fixed delay.
+/// Derived classes may override Get_Latency() to model other distributions.
+class CH_VEHICLE_API ChSensorLatency {
+ public:
+  ChSensorLatency(const LatencyDistribution distribution, const double scale);
+
+  virtual ~ChSensorLatency() = default;
+
+  /// Draw the (non negative) latency of the next sample [s].
+  virtual double Get_Latency();
+
+  /// Reseed the random generator, for reproducible runs.
+  void Set_Seed(const unsigned int seed) { m_gen.seed(seed); }
+
+  /// Write the parameters and the random generator state to a binary snapshot.
+  virtual void SnapshotOut(ChSensorSnapshot &snapshot) const;
+
+  virtual bool SnapshotIn(ChSensorSnapshot &snapshot);
+
+  LatencyDistribution Get_Distribution() const { return m_distribution; }
+
+  double Get_Scale() const { return m_scale; }
+
+ protected:
+  LatencyDistribution m_distribution;
+  double m_scale;
+  std::default_random_engine m_gen;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORLATENCY_H
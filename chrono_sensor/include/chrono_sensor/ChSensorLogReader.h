@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORLOGREADER_H
+#define CHRONO_SENSOR_CHSENSORLOGREADER_H
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Reader of recorded sensor traces in chunks of rows, so traces larger than the memory can be processed.
+/// Two formats are recognized:
+/// - CSV as written by ChSensor::Log(), with a header line and comma separated fields, where the components of
+///   vectors and quaternions are separated by spaces within a field. Every component becomes a column.
+///   The runs of a LOG_ON_CHANGE log (a last header field "Count") are expanded to one row per Log() call, with the
+///   times spaced evenly up to the next run; the Count column itself isn't returned.
+/// - Binary, starting with the magic "CHSL", a uint32_t version and a uint32_t number of columns, followed by rows
+///   of native doubles.
+class CH_VEHICLE_API ChSensorLogReader {
+ public:
+  static constexpr uint32_t BINARY_VERSION = 1;
+
+  ChSensorLogReader();
+
+  /// Open a log and read its header and, for CSV, the first row to find the columns.
+  bool Open(const std::string &filename);
+
+  void Close();
+
+  bool Is_Binary() const { return m_binary; }
+
+  /// True for a run-length encoded LOG_ON_CHANGE log.
+  bool Is_RunLength() const { return m_run_length; }
+
+  size_t Get_Columns() const { return m_names.size(); }
+
+  /// Column names, e.g. "Time", "Input[0]".
+  const std::vector<std::string> &Get_Names() const { return m_names; }
+
+  /// Read up to the given number of rows, replacing the contents of rows (row major). Returns the number of rows
+  /// read, 0 at the end of the log.
+  size_t Read(std::vector<double> &rows, size_t max_rows);
+
+  /// Number of CSV lines skipped because they did not have the number of columns of the first row.
+  size_t Get_Skipped() const { return m_skipped; }
+
+  /// Write the header of a binary log, to be followed by the rows.
+  static void Write_BinaryHeader(std::ostream &out, uint32_t columns);
+
+ private:
+  /// Parse the numbers of a CSV line, returning the number of components per field.
+  static bool Parse_Line(const std::string &line, std::vector<double> &values, std::vector<size_t> *fields);
+
+  /// Read the next well formed CSV row, including the Count column of a run-length log.
+  bool Next_Row(std::vector<double> &values);
+
+  std::ifstream m_file;
+  bool m_binary;
+  bool m_run_length;
+  std::vector<std::string> m_names;
+  std::vector<double> m_first;  ///< First CSV row, read to find the columns
+  size_t m_skipped;
+  std::vector<double> m_run;        ///< Current run of a run-length log, with its count
+  std::vector<double> m_following;  ///< Run after the current one, read ahead for the time spacing
+  size_t m_run_count;
+  size_t m_run_next;   ///< Number of rows of the current run returned so far
+  double m_run_step;   ///< Time between the rows of the current run
+  bool m_run_timed;    ///< True once the spacing of the current run is known
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORLOGREADER_H
@@ -0,0 +1,120 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORMAHONY_H
+#define CHRONO_SENSOR_CHSENSORMAHONY_H
+
+#include <vector>
+
+#include "chrono/core/ChQuaternion.h"
+#include "chrono/core/ChVector.h"
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Mahony complementary filter of the attitude of a vehicle from gyroscope and accelerometer (and optionally
+/// magnetometer) outputs in the body frame. The direction of gravity, and of the horizontal magnetic field, measured
+/// in the body frame is compared with the one predicted from the attitude; the error drives a proportional and
+/// integral correction of the angular velocity, which is then integrated. The accelerometer output must contain
+/// gravity (specific force), pointing up along +Z at rest.
+/// This is the scalar reference of ChSensorMahonyBank.
+class CH_VEHICLE_API ChSensorMahony {
+ public:
+  ChSensorMahony(double kp = 1., double ki = 0.);
+
+  /// Proportional and integral gains of the correction.
+  void Set_Gains(double kp, double ki);
+
+  void Set_Orientation(const ChQuaternion<> &Orientation) { m_orientation = Orientation.GetNormalized(); }
+
+  /// Orientation of the body frame in the world frame.
+  const ChQuaternion<> &Get_Orientation() const { return m_orientation; }
+
+  /// Integral of the correction, the estimate of the opposite of the gyroscope bias [rad/s].
+  const ChVector<> &Get_Integral() const { return m_integral; }
+
+  void Update(double dt, const ChVector<> &angular_velocity, const ChVector<> &acceleration);
+
+  void Update(double dt, const ChVector<> &angular_velocity, const ChVector<> &acceleration,
+              const ChVector<> &magnetic_field);
+
+ private:
+  void Correct(double dt, const ChVector<> &angular_velocity, const ChVector<> &error);
+
+  double m_kp;
+  double m_ki;
+  ChQuaternion<> m_orientation;
+  ChVector<> m_integral;
+};
+
+/// Mahony filters of many vehicles with the same gains, e.g. a fleet, updated together. The states and the inputs
+/// are stored by component (structure of arrays), so one update is a single vectorized loop over the instances,
+/// without per instance calls or branches.
+class CH_VEHICLE_API ChSensorMahonyBank {
+ public:
+  explicit ChSensorMahonyBank(size_t count = 0, double kp = 1., double ki = 0.);
+
+  /// Change the number of instances; new instances start level with a zero integral.
+  void Resize(size_t count);
+
+  size_t Size() const { return m_q[0].size(); }
+
+  void Set_Gains(double kp, double ki);
+
+  void Set_Orientation(size_t i, const ChQuaternion<> &orientation);
+
+  ChQuaternion<> Get_Orientation(size_t i) const;
+
+  ChVector<> Get_Integral(size_t i) const;
+
+  /// Orientation component (0 to 3, e0 to e3) of all instances.
+  const double *Get_Orientation(int component) const { return m_q[component].data(); }
+
+  /// Update all instances from component arrays of the gyroscope and accelerometer outputs.
+  void Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax, const double *ay,
+              const double *az);
+
+  /// Update all instances from component arrays of the gyroscope, accelerometer and magnetometer outputs.
+  void Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax, const double *ay,
+              const double *az, const double *mx, const double *my, const double *mz);
+
+  /// Update all instances from arrays of sensor outputs, gathered by component first.
+  void Update(double dt, const ChVector<> *angular_velocity, const ChVector<> *acceleration);
+
+ private:
+  void Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax, const double *ay,
+              const double *az, const double *mx, const double *my, const double *mz, bool magnetic);
+
+  double m_kp;
+  double m_ki;
+  std::vector<double> m_q[4];
+  std::vector<double> m_integral[3];
+  std::vector<double> m_input[6];  ///< Gathered inputs of the array of structures update
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORMAHONY_H
@@ -0,0 +1,216 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORMATRIX_H
+#define CHRONO_SENSOR_CHSENSORMATRIX_H
+
+#include <cmath>
+
+#include "chrono/core/ChQuaternion.h"
+#include "chrono/core/ChVector.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Small dense matrix of compile time size, stored row major in place, for estimators that must not allocate.
+/// The loops have constant bounds, so the compiler unrolls and vectorizes them.
+template<int R, int C>
+class ChSensorMatrix {
+ public:
+  /// Zero matrix.
+  ChSensorMatrix() {
+    for (int i = 0; i < R * C; ++i)
+      m_data[i] = 0.;
+  }
+
+  static ChSensorMatrix<R, C> Identity() {
+    ChSensorMatrix<R, C> identity;
+    for (int i = 0; i < R && i < C; ++i)
+      identity(i, i) = 1.;
+    return identity;
+  }
+
+  double &operator()(int r, int c) { return m_data[r * C + c]; }
+
+  double operator()(int r, int c) const { return m_data[r * C + c]; }
+
+  /// Element of a column vector.
+  double &operator[](int i) { return m_data[i]; }
+
+  double operator[](int i) const { return m_data[i]; }
+
+  ChSensorMatrix<R, C> operator+(const ChSensorMatrix<R, C> &other) const {
+    ChSensorMatrix<R, C> result;
+    for (int i = 0; i < R * C; ++i)
+      result.m_data[i] = m_data[i] + other.m_data[i];
+    return result;
+  }
+
+  ChSensorMatrix<R, C> operator-(const ChSensorMatrix<R, C> &other) const {
+    ChSensorMatrix<R, C> result;
+    for (int i = 0; i < R * C; ++i)
+      result.m_data[i] = m_data[i] - other.m_data[i];
+    return result;
+  }
+
+  ChSensorMatrix<R, C> operator*(double scale) const {
+    ChSensorMatrix<R, C> result;
+    for (int i = 0; i < R * C; ++i)
+      result.m_data[i] = m_data[i] * scale;
+    return result;
+  }
+
+  template<int K>
+  ChSensorMatrix<R, K> operator*(const ChSensorMatrix<C, K> &other) const {
+    ChSensorMatrix<R, K> result;
+    for (int r = 0; r < R; ++r) {
+      for (int c = 0; c < C; ++c) {
+        double a = (*this)(r, c);
+        for (int k = 0; k < K; ++k)
+          result(r, k) += a * other(c, k);
+      }
+    }
+    return result;
+  }
+
+  ChSensorMatrix<C, R> Transpose() const {
+    ChSensorMatrix<C, R> result;
+    for (int r = 0; r < R; ++r) {
+      for (int c = 0; c < C; ++c)
+        result(c, r) = (*this)(r, c);
+    }
+    return result;
+  }
+
+  /// Replace the matrix by the average with its transpose, against the drift of covariances.
+  void Symmetrize() {
+    static_assert(R == C, "Only square matrices are symmetrized");
+    for (int r = 0; r < R; ++r) {
+      for (int c = r + 1; c < C; ++c) {
+        double mean = 0.5 * ((*this)(r, c) + (*this)(c, r));
+        (*this)(r, c) = mean;
+        (*this)(c, r) = mean;
+      }
+    }
+  }
+
+  template<int BR, int BC>
+  ChSensorMatrix<BR, BC> Get_Block(int r, int c) const {
+    ChSensorMatrix<BR, BC> block;
+    for (int i = 0; i < BR; ++i) {
+      for (int j = 0; j < BC; ++j)
+        block(i, j) = (*this)(r + i, c + j);
+    }
+    return block;
+  }
+
+  template<int BR, int BC>
+  void Set_Block(int r, int c, const ChSensorMatrix<BR, BC> &block) {
+    for (int i = 0; i < BR; ++i) {
+      for (int j = 0; j < BC; ++j)
+        (*this)(r + i, c + j) = block(i, j);
+    }
+  }
+
+  /// Three rows of a column vector.
+  ChVector<> Get_Vector(int r) const { return ChVector<>(m_data[r], m_data[r + 1], m_data[r + 2]); }
+
+  void Set_Vector(int r, const ChVector<> &v) {
+    m_data[r] = v.x();
+    m_data[r + 1] = v.y();
+    m_data[r + 2] = v.z();
+  }
+
+  /// Solve A X = B in place for a symmetric positive definite A with a Cholesky factorization (A is overwritten).
+  /// Fails if A is not positive definite.
+  template<int K>
+  static bool Solve_Spd(ChSensorMatrix<R, R> &A, ChSensorMatrix<R, K> &B) {
+    for (int j = 0; j < R; ++j) {
+      double d = A(j, j);
+      for (int k = 0; k < j; ++k)
+        d -= A(j, k) * A(j, k);
+      if (!(d > 0.))
+        return false;
+      A(j, j) = std::sqrt(d);
+      for (int i = j + 1; i < R; ++i) {
+        double s = A(i, j);
+        for (int k = 0; k < j; ++k)
+          s -= A(i, k) * A(j, k);
+        A(i, j) = s / A(j, j);
+      }
+    }
+    for (int k = 0; k < K; ++k) {
+      // L y = b, then L^T x = y
+      for (int i = 0; i < R; ++i) {
+        double s = B(i, k);
+        for (int j = 0; j < i; ++j)
+          s -= A(i, j) * B(j, k);
+        B(i, k) = s / A(i, i);
+      }
+      for (int i = R - 1; i >= 0; --i) {
+        double s = B(i, k);
+        for (int j = i + 1; j < R; ++j)
+          s -= A(j, i) * B(j, k);
+        B(i, k) = s / A(i, i);
+      }
+    }
+    return true;
+  }
+
+ private:
+  double m_data[R * C];
+};
+
+/// Cross product matrix, [v] w = v x w.
+inline ChSensorMatrix<3, 3> Skew(const ChVector<> &v) {
+  ChSensorMatrix<3, 3> m;
+  m(0, 1) = -v.z();
+  m(0, 2) = v.y();
+  m(1, 0) = v.z();
+  m(1, 2) = -v.x();
+  m(2, 0) = -v.y();
+  m(2, 1) = v.x();
+  return m;
+}
+
+/// Rotation matrix of a unit quaternion.
+inline ChSensorMatrix<3, 3> Rotation(const ChQuaternion<> &q) {
+  double w = q.e0(), x = q.e1(), y = q.e2(), z = q.e3();
+  ChSensorMatrix<3, 3> m;
+  m(0, 0) = 1. - 2. * (y * y + z * z);
+  m(0, 1) = 2. * (x * y - w * z);
+  m(0, 2) = 2. * (x * z + w * y);
+  m(1, 0) = 2. * (x * y + w * z);
+  m(1, 1) = 1. - 2. * (x * x + z * z);
+  m(1, 2) = 2. * (y * z - w * x);
+  m(2, 0) = 2. * (x * z - w * y);
+  m(2, 1) = 2. * (y * z + w * x);
+  m(2, 2) = 1. - 2. * (x * x + y * y);
+  return m;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORMATRIX_H
@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORPIPELINE_H
+#define CHRONO_SENSOR_CHSENSORPIPELINE_H
+
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "chrono_sensor/ChFunction_SensorBias.h"
+#include "chrono_sensor/ChFunction_SensorDigitize.h"
+#include "chrono_sensor/ChFunction_SensorNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Compile a transform chain into the minimal pipeline with the same (statistical) output.
+/// - Digitizers with zero bits are identities and are dropped.
+/// - Each run of consecutive bias and white noise stages is additive, so it is folded into a single stage: the
+///   biases and noise means are summed and the noise covariances added. Runs without noise become one bias, runs
+///   that sum to zero disappear.
+/// Stages that aren't folded (including all stateful ones) are used as is; the fused stages are owned by 'fused'.
+/// Only exact instances are folded, subclasses may override Get_y() and pass through unchanged.
+/// Quaternion chains are multiplicative and only drop the identity digitizers.
+template<typename T>
+void Compile_Pipeline(const std::vector<std::shared_ptr<ChFunction_Sensor<T>>> &chain,
+                      std::vector<std::shared_ptr<ChFunction_Sensor<T>>> &fused,
+                      std::vector<ChFunction_Sensor<T> *> &pipeline) {
+  fused.clear();
+  pipeline.clear();
+  pipeline.reserve(chain.size());
+
+  std::vector<ChFunction_Sensor<T> *> run;
+  T bias(0.);
+  T variance(0.);
+  typename ChFunction_SensorNoise<T>::Covariance covariance{};
+  bool noise = false;
+  bool correlated = false;
+
+  auto flush = [&]() {
+    if (run.empty()) {
+      return;
+    } else if (!noise && bias == T(0.)) {
+      // The run is an identity
+    } else if (run.size() == 1) {
+      pipeline.push_back(run[0]);
+    } else if (noise) {
+      T stddev;
+      if constexpr(std::is_same<T, double>::value) {
+        stddev = std::sqrt(variance);
+      } else if constexpr(std::is_same<T, ChVector<>>::value) {
+        stddev = T(std::sqrt(variance.x()), std::sqrt(variance.y()), std::sqrt(variance.z()));
+      }
+      auto f_noise = std::make_shared<ChFunction_SensorNoise<T>>(bias, stddev);
+      if (correlated) {
+        f_noise->Set_Covariance(covariance);
+      }
+      fused.push_back(f_noise);
+      pipeline.push_back(fused.back().get());
+    } else {
+      fused.push_back(std::make_shared<ChFunction_SensorBias<T>>(bias));
+      pipeline.push_back(fused.back().get());
+    }
+    run.clear();
+    bias = T(0.);
+    variance = T(0.);
+    covariance.fill(0.);
+    noise = false;
+    correlated = false;
+  };
+
+  for (auto &transform : chain) {
+    auto &type = typeid(*transform);
+    if (type == typeid(ChFunction_SensorDigitize<T>)
+        && static_cast<ChFunction_SensorDigitize<T> *>(transform.get())->Get_Bits() == 0.)
+      continue;
+
+    if constexpr(!std::is_same<T, ChQuaternion<>>::value) {
+      if (type == typeid(ChFunction_SensorBias<T>)) {
+        bias += static_cast<ChFunction_SensorBias<T> *>(transform.get())->Get_Bias();
+        run.push_back(transform.get());
+        continue;
+      }
+      if (type == typeid(ChFunction_SensorNoise<T>)) {
+        auto f_noise = static_cast<ChFunction_SensorNoise<T> *>(transform.get());
+        bias += f_noise->Get_Mean();
+        variance += f_noise->Get_Stddev() * f_noise->Get_Stddev();
+        noise = noise || !(f_noise->Get_Stddev() == T(0.));
+        correlated = correlated || f_noise->Is_Correlated();
+        auto stage_covariance = f_noise->Get_Covariance();
+        for (size_t i = 0; i < covariance.size(); ++i) {
+          covariance[i] += stage_covariance[i];
+        }
+        run.push_back(transform.get());
+        continue;
+      }
+      flush();
+    }
+    pipeline.push_back(transform.get());
+  }
+  if constexpr(!std::is_same<T, ChQuaternion<>>::value) {
+    flush();
+  }
+}
+
+/// Return a human readable description of a pipeline, one stage per line.
+template<typename T>
+std::string Describe_Pipeline(const std::vector<ChFunction_Sensor<T> *> &pipeline) {
+  std::ostringstream out;
+  for (size_t i = 0; i < pipeline.size(); ++i) {
+    out << i << ": ";
+    auto transform = pipeline[i];
+    switch (transform->Get_Type()) {
+      case FUNCT_NOISE: {
+        auto f_noise = static_cast<ChFunction_SensorNoise<T> *>(transform);
+        out << "NOISE mean=" << f_noise->Get_Mean() << " stddev=" << f_noise->Get_Stddev();
+        if (f_noise->Is_Correlated()) {
+          out << " correlated";
+        }
+        break;
+      }
+      case FUNCT_BIAS:out << "BIAS bias=" << static_cast<ChFunction_SensorBias<T> *>(transform)->Get_Bias();
+        break;
+      case FUNCT_DIGITIZE: {
+        auto f_digitize = static_cast<ChFunction_SensorDigitize<T> *>(transform);
+        out << "DIGITIZE bits=" << f_digitize->Get_Bits() << " range=" << f_digitize->Get_Range();
+        break;
+      }
+      case FUNCT_RANDOM_WALK:out << "RANDOM_WALK";
+        break;
+      case FUNCT_GAUSS_MARKOV:out << "GAUSS_MARKOV";
+        break;
+      case FUNCT_FLICKER:out << "FLICKER";
+        break;
+      case FUNCT_FILTER:out << "FILTER";
+        break;
+      case FUNCT_TABLE:out << "TABLE";
+        break;
+      case FUNCT_ORIENTATION_NOISE:out << "ORIENTATION_NOISE";
+        break;
+      default:out << "CUSTOM";
+        break;
+    }
+    out << "\n";
+  }
+  return out.str();
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORPIPELINE_H
@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSEQLOCK_H
+#define CHRONO_SENSOR_CHSENSORSEQLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Sequence lock over a fixed number of values, for one writer thread and any number of reader threads.
+/// The writer never waits; readers retry while a write is in progress, so they always get a consistent copy.
+/// The values are relaxed atomics, so the racing reads are well defined and only the sequence check decides
+/// whether a copy is kept.
+template<size_t N>
+class ChSensorSeqLock {
+ public:
+  ChSensorSeqLock() : m_seq(0) {
+    for (auto &value : m_values) {
+      value.store(0., std::memory_order_relaxed);
+    }
+  }
+
+  ChSensorSeqLock(const ChSensorSeqLock &) = delete;
+  ChSensorSeqLock &operator=(const ChSensorSeqLock &) = delete;
+
+  /// Writer side: publish N values.
+  void Write(const double *values) {
+    uint64_t seq = m_seq.load(std::memory_order_relaxed);
+    m_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < N; ++i) {
+      m_values[i].store(values[i], std::memory_order_relaxed);
+    }
+    m_seq.store(seq + 2, std::memory_order_release);
+  }
+
+  /// Reader side: copy the last published values and return their version (the number of writes).
+  uint64_t Read(double *values) const {
+    while (true) {
+      uint64_t seq = m_seq.load(std::memory_order_acquire);
+      if (seq & 1)
+        continue;
+      for (size_t i = 0; i < N; ++i) {
+        values[i] = m_values[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_seq.load(std::memory_order_relaxed) == seq)
+        return seq / 2;
+    }
+  }
+
+  /// Return the number of writes so far.
+  uint64_t Get_Version() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+ private:
+  alignas(64) std::atomic<uint64_t> m_seq;
+  std::atomic<double> m_values[N];
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSEQLOCK_H
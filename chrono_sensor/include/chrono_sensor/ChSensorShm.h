@@ -0,0 +1,301 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSHM_H
+#define CHRONO_SENSOR_CHSENSORSHM_H
+
+// Shared memory transport of released sensor samples to other processes on the same host. This header only
+// depends on the standard library and POSIX (link with -lrt), so subscribers can use it without Chrono.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+static const char SHM_MAGIC[4] = {'C', 'H', 'S', 'S'};
+static const uint32_t SHM_VERSION = 1;
+static const int SHM_READ_RETRIES = 1000;  ///< Attempts to read a record being written before giving up
+
+// Atomics shared between processes must be lock free, an embedded lock would only be private to each process
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ChSensorShm requires lock free 64 bit atomics");
+static_assert(std::atomic<double>::is_always_lock_free, "ChSensorShm requires lock free atomic doubles");
+
+/// Region header, followed by the ring of records.
+struct ChSensorShmHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t dim;       ///< Number of used value components: 1 (double), 3 (vector) or 4 (quaternion)
+  uint32_t capacity;  ///< Number of records in the ring, a power of two
+  alignas(64) std::atomic<uint64_t> count;  ///< Number of records written so far
+};
+
+/// One sample, a cache line. The record is protected by its own sequence lock: the sequence is odd while the
+/// publisher writes it. The fields are relaxed atomics, so racing reads are well defined and only the sequence
+/// check decides whether a copy is consistent.
+struct alignas(64) ChSensorShmRecord {
+  std::atomic<uint64_t> seq;
+  std::atomic<uint64_t> index;  ///< Position of the sample in the stream
+  std::atomic<double> time;
+  std::atomic<double> release;
+  std::atomic<double> value[4];
+};
+
+/// Consistent copy of a record.
+struct ChSensorShmSample {
+  uint64_t index;
+  double time;     ///< Sample instant
+  double release;  ///< Instant the sample was released
+  double value[4];
+};
+
+/// Shared memory mapping of a sensor stream.
+class ChSensorShmRegion {
+ public:
+  ChSensorShmRegion() : m_header(nullptr), m_records(nullptr), m_size(0) {}
+
+  ChSensorShmRegion(const ChSensorShmRegion &) = delete;
+  ChSensorShmRegion &operator=(const ChSensorShmRegion &) = delete;
+
+  ~ChSensorShmRegion() { Close(); }
+
+  /// Create (or replace) the named region with a ring of at least the given number of records. A replaced region
+  /// is unlinked rather than reused, so subscribers that still map it keep a valid (but no longer written) stream
+  /// until they open the name again.
+  bool Create(const std::string &name, const uint32_t dim, const uint32_t capacity) {
+    Close();
+    uint32_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    size_t size = Region_Size(n);
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+      return false;
+    bool ok = ftruncate(fd, static_cast<off_t>(size)) == 0 && Map(fd, size, PROT_READ | PROT_WRITE);
+    close(fd);
+    if (!ok) {
+      Close();
+      shm_unlink(name.c_str());
+      return false;
+    }
+
+    // The new object is zero filled, so the magic only becomes valid once the region is initialized
+    m_header->version = SHM_VERSION;
+    m_header->dim = dim;
+    m_header->capacity = n;
+    m_header->count.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; ++i) {
+      m_records[i].seq.store(0, std::memory_order_relaxed);
+      m_records[i].index.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_header->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+    return true;
+  }
+
+  /// Map an existing region read only. Fails if it doesn't exist or has another layout version.
+  bool Open(const std::string &name) {
+    Close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ChSensorShmHeader)
+        && Map(fd, st.st_size, PROT_READ);
+    close(fd);
+    if (!ok)
+      return false;
+    if (std::memcmp(m_header->magic, SHM_MAGIC, sizeof(SHM_MAGIC)) != 0 || m_header->version != SHM_VERSION
+        || m_size < Region_Size(m_header->capacity)) {
+      Close();
+      return false;
+    }
+    return true;
+  }
+
+  void Close() {
+    if (m_header)
+      munmap(m_header, m_size);
+    m_header = nullptr;
+    m_records = nullptr;
+    m_size = 0;
+  }
+
+  /// Remove the name of a region; existing mappings stay valid.
+  static bool Unlink(const std::string &name) { return shm_unlink(name.c_str()) == 0; }
+
+  bool Is_Open() const { return m_header != nullptr; }
+
+  ChSensorShmHeader *Get_Header() const { return m_header; }
+
+  ChSensorShmRecord *Get_Records() const { return m_records; }
+
+ private:
+  static size_t Region_Size(const uint32_t capacity) {
+    return sizeof(ChSensorShmHeader) + static_cast<size_t>(capacity) * sizeof(ChSensorShmRecord);
+  }
+
+  bool Map(const int fd, const size_t size, const int protection) {
+    void *address = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+      return false;
+    m_header = static_cast<ChSensorShmHeader *>(address);
+    m_records = reinterpret_cast<ChSensorShmRecord *>(static_cast<char *>(address) + sizeof(ChSensorShmHeader));
+    m_size = size;
+    return true;
+  }
+
+  ChSensorShmHeader *m_header;
+  ChSensorShmRecord *m_records;
+  size_t m_size;
+};
+
+/// Publisher side of a stream; a single writer per region. Writing never blocks, slow subscribers lose the
+/// records overwritten by the ring.
+class ChSensorShmWriter {
+ public:
+  bool Create(const std::string &name, const uint32_t dim, const uint32_t capacity = 1024) {
+    return m_region.Create(name, dim, capacity);
+  }
+
+  void Write(const double time, const double release, const double *value) {
+    ChSensorShmHeader *header = m_region.Get_Header();
+    uint64_t n = header->count.load(std::memory_order_relaxed);
+    ChSensorShmRecord &record = m_region.Get_Records()[n & (header->capacity - 1)];
+    uint64_t seq = record.seq.load(std::memory_order_relaxed);
+    record.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.index.store(n, std::memory_order_relaxed);
+    record.time.store(time, std::memory_order_relaxed);
+    record.release.store(release, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < 4; ++i) {
+      record.value[i].store(i < header->dim ? value[i] : 0., std::memory_order_relaxed);
+    }
+    record.seq.store(seq + 2, std::memory_order_release);
+    header->count.store(n + 1, std::memory_order_release);
+  }
+
+  bool Is_Open() const { return m_region.Is_Open(); }
+
+ private:
+  ChSensorShmRegion m_region;
+};
+
+/// Subscriber side of a stream. Each subscriber keeps its own read position, starting at the oldest record
+/// still in the ring.
+class ChSensorShmSubscriber {
+ public:
+  ChSensorShmSubscriber() : m_next(0), m_lost(0) {}
+
+  bool Open(const std::string &name) {
+    m_next = 0;
+    m_lost = 0;
+    return m_region.Open(name);
+  }
+
+  /// Copy up to max_count new samples, oldest first, and return their number. Stops early at a record that stays
+  /// being written (ex. the publisher died during a write); the next call tries it again.
+  size_t Read(ChSensorShmSample *samples, const size_t max_count) {
+    const ChSensorShmHeader *header = m_region.Get_Header();
+    size_t read = 0;
+    while (read < max_count) {
+      uint64_t count = header->count.load(std::memory_order_acquire);
+      if (m_next == count)
+        break;
+      if (count - m_next > header->capacity) {
+        // The publisher lapped us, skip to the oldest record still in the ring
+        m_lost += count - header->capacity - m_next;
+        m_next = count - header->capacity;
+      }
+      auto result = Read_Record(m_next, samples[read]);
+      if (result == RECORD_BUSY)
+        break;
+      if (result == RECORD_READ) {
+        ++read;
+      } else {
+        // Overwritten before the count was advanced
+        ++m_lost;
+      }
+      ++m_next;
+    }
+    return read;
+  }
+
+  /// Number of samples overwritten before they were read.
+  uint64_t Get_Lost() const { return m_lost; }
+
+  uint32_t Get_Dim() const { return m_region.Get_Header()->dim; }
+
+  bool Is_Open() const { return m_region.Is_Open(); }
+
+ private:
+  enum RecordResult {
+    RECORD_READ,         ///< The sample was copied
+    RECORD_OVERWRITTEN,  ///< The record already holds a newer sample
+    RECORD_BUSY          ///< The record was being written on every attempt
+  };
+
+  /// Copy the record at the given stream position. Retries a bounded number of times, yielding in between, while
+  /// it is being written.
+  RecordResult Read_Record(const uint64_t index, ChSensorShmSample &sample) const {
+    const ChSensorShmHeader *header = m_region.Get_Header();
+    const ChSensorShmRecord &record = m_region.Get_Records()[index & (header->capacity - 1)];
+    for (int attempt = 0; attempt < SHM_READ_RETRIES; ++attempt) {
+      if (attempt > 0)
+        std::this_thread::yield();
+      uint64_t seq = record.seq.load(std::memory_order_acquire);
+      if (seq & 1)
+        continue;
+      sample.index = record.index.load(std::memory_order_relaxed);
+      sample.time = record.time.load(std::memory_order_relaxed);
+      sample.release = record.release.load(std::memory_order_relaxed);
+      for (int i = 0; i < 4; ++i) {
+        sample.value[i] = record.value[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (record.seq.load(std::memory_order_relaxed) != seq)
+        continue;
+      return sample.index == index ? RECORD_READ : RECORD_OVERWRITTEN;
+    }
+    return RECORD_BUSY;
+  }
+
+  ChSensorShmRegion m_region;
+  uint64_t m_next;
+  uint64_t m_lost;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSHM_H
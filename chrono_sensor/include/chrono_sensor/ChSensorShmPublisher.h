@@ -0,0 +1,73 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSHMPUBLISHER_H
+#define CHRONO_SENSOR_CHSENSORSHMPUBLISHER_H
+
+#include <string>
+
+#include "chrono_sensor/ChSensor.h"
+#include "chrono_sensor/ChSensorShm.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Output callback publishing the released samples of a sensor to a shared memory region, read by
+/// ChSensorShmSubscriber in other processes. Vectors and quaternions are published by component.
+template<class T>
+class ChSensorShmPublisher : public ChSensor<T>::OutputCallback {
+ public:
+  /// Create the named region (e.g. "/vehicle_acc") with a ring of at least the given number of samples.
+  bool Open(const std::string &name, const uint32_t capacity = 1024) {
+    m_name = name;
+    return m_writer.Create(name, DIM, capacity);
+  }
+
+  void OnOutput(const ChSensorSample<T> &sample) override {
+    if (!m_writer.Is_Open())
+      return;
+    double value[4];
+    if constexpr(std::is_same<T, double>::value) {
+      value[0] = sample.value;
+    } else {
+      for (uint32_t i = 0; i < DIM; ++i) {
+        value[i] = sample.value[i];
+      }
+    }
+    m_writer.Write(sample.time, sample.release, value);
+  }
+
+  const std::string &Get_Name() const { return m_name; }
+
+ private:
+  static constexpr uint32_t DIM = std::is_same<T, double>::value ? 1 : (std::is_same<T, ChVector<>>::value ? 3 : 4);
+
+  ChSensorShmWriter m_writer;
+  std::string m_name;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSHMPUBLISHER_H
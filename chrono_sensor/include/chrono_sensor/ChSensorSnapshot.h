@@ -0,0 +1,206 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSNAPSHOT_H
+#define CHRONO_SENSOR_CHSENSORSNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "chrono/core/ChMatrix33.h"
+#include "chrono/core/ChQuaternion.h"
+#include "chrono/core/ChVector.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Compact binary image of the complete state of sensors and transforms, for checkpointing and bit exact restarts.
+/// Values are copied in their native representation, so a snapshot is only meant to be restored by the same build
+/// on the same platform. Reads return false once the data is exhausted.
+class ChSensorSnapshot {
+ public:
+  ChSensorSnapshot() : m_pos(0) {}
+
+  /// Write a trivially copyable value (numbers, enums, plain structs and arrays of them).
+  template<class V>
+  void Write(const V &value) {
+    static_assert(std::is_trivially_copyable<V>::value, "ChSensorSnapshot::Write requires a trivially copyable type");
+    Write_Bytes(&value, sizeof(V));
+  }
+
+  void Write(const ChVector<> &value) { Write_Bytes(value.data(), 3 * sizeof(double)); }
+
+  void Write(const ChQuaternion<> &value) { Write_Bytes(value.data(), 4 * sizeof(double)); }
+
+  void Write(const ChMatrix33<> &value) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        Write(value(r, c));
+      }
+    }
+  }
+
+  /// Write the size and the elements of a vector, as one block for trivially copyable elements.
+  template<class V>
+  void Write(const std::vector<V> &values) {
+    Write(static_cast<uint64_t>(values.size()));
+    if constexpr(std::is_trivially_copyable<V>::value) {
+      Write_Bytes(values.data(), values.size() * sizeof(V));
+    } else {
+      for (const auto &value : values) {
+        Write(value);
+      }
+    }
+  }
+
+  /// Write the state of a random engine.
+  template<class Engine>
+  void Write_Engine(const Engine &engine) {
+    if constexpr(std::is_trivially_copyable<Engine>::value) {
+      Write(engine);
+    } else {
+      std::ostringstream out;
+      out << engine;
+      std::string text = out.str();
+      Write(static_cast<uint64_t>(text.size()));
+      Write_Bytes(text.data(), text.size());
+    }
+  }
+
+  template<class V>
+  bool Read(V &value) {
+    static_assert(std::is_trivially_copyable<V>::value, "ChSensorSnapshot::Read requires a trivially copyable type");
+    return Read_Bytes(&value, sizeof(V));
+  }
+
+  bool Read(ChVector<> &value) { return Read_Bytes(value.data(), 3 * sizeof(double)); }
+
+  bool Read(ChQuaternion<> &value) { return Read_Bytes(value.data(), 4 * sizeof(double)); }
+
+  bool Read(ChMatrix33<> &value) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        if (!Read(value(r, c)))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  template<class V>
+  bool Read(std::vector<V> &values) {
+    uint64_t size;
+    if (!Read(size) || size > m_data.size() - m_pos)
+      return false;
+    values.resize(size);
+    if constexpr(std::is_trivially_copyable<V>::value) {
+      return Read_Bytes(values.data(), size * sizeof(V));
+    } else {
+      for (auto &value : values) {
+        if (!Read(value))
+          return false;
+      }
+      return true;
+    }
+  }
+
+  template<class Engine>
+  bool Read_Engine(Engine &engine) {
+    if constexpr(std::is_trivially_copyable<Engine>::value) {
+      return Read(engine);
+    } else {
+      uint64_t size;
+      if (!Read(size) || size > m_data.size() - m_pos)
+        return false;
+      std::istringstream in(std::string(m_data.data() + m_pos, size));
+      m_pos += size;
+      in >> engine;
+      return !in.fail();
+    }
+  }
+
+  /// Restart reading from the beginning.
+  void Rewind() { m_pos = 0; }
+
+  void Clear() {
+    m_data.clear();
+    m_pos = 0;
+  }
+
+  size_t Size() const { return m_data.size(); }
+
+  const std::vector<char> &Get_Data() const { return m_data; }
+
+  void Set_Data(const std::vector<char> &data) {
+    m_data = data;
+    m_pos = 0;
+  }
+
+  bool Save(const std::string &filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(m_data.data(), m_data.size());
+    return static_cast<bool>(out);
+  }
+
+  bool Load(const std::string &filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in)
+      return false;
+    m_data.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(m_data.data(), m_data.size());
+    m_pos = 0;
+    return static_cast<bool>(in);
+  }
+
+ private:
+  void Write_Bytes(const void *data, const size_t size) {
+    size_t pos = m_data.size();
+    m_data.resize(pos + size);
+    if (size > 0)
+      std::memcpy(m_data.data() + pos, data, size);
+  }
+
+  bool Read_Bytes(void *data, const size_t size) {
+    if (size > m_data.size() - m_pos)
+      return false;
+    if (size > 0)
+      std::memcpy(data, m_data.data() + m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+  std::vector<char> m_data;
+  size_t m_pos;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSNAPSHOT_H
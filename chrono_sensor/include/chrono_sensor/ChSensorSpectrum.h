@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSPECTRUM_H
+#define CHRONO_SENSOR_CHSENSORSPECTRUM_H
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "chrono_vehicle/ChApiVehicle.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Minimal in place radix 2 FFT of a fixed power of two size, with precomputed twiddle factors.
+class CH_VEHICLE_API ChSensorFFT {
+ public:
+  /// The size is rounded up to a power of two.
+  explicit ChSensorFFT(size_t size);
+
+  /// Forward transform, X_k = sum_n x_n exp(-2 pi i k n / N).
+  void Forward(std::complex<double> *data) const;
+
+  size_t Get_Size() const { return m_size; }
+
+ private:
+  size_t m_size;
+  std::vector<std::complex<double>> m_twiddle;
+  std::vector<size_t> m_reverse;
+};
+
+/// Streaming Welch estimate of the one sided power spectral density of a sampled signal: Hann windowed segments
+/// overlapping by half are transformed and their periodograms averaged. Samples are added in blocks of any size;
+/// only the incomplete last segment is kept between blocks, so traces of any length are processed in constant
+/// memory. The segments of a block are transformed in parallel over the OpenMP threads.
+class CH_VEHICLE_API ChSensorWelch {
+ public:
+  /// Segment length (rounded up to a power of two) and sample rate [Hz].
+  ChSensorWelch(size_t segment, double sample_rate);
+
+  /// Add consecutive samples, read with the given stride.
+  void Add(const double *samples, size_t count, size_t stride = 1);
+
+  /// Power spectral density [unit^2/Hz] at the frequencies of Get_Frequency(), from DC to the Nyquist frequency.
+  std::vector<double> Get_PSD() const;
+
+  double Get_Frequency(size_t bin) const { return bin * m_sample_rate / m_fft.Get_Size(); }
+
+  size_t Get_Bins() const { return m_fft.Get_Size() / 2 + 1; }
+
+  /// Number of segments averaged so far.
+  size_t Get_Segments() const { return m_segments; }
+
+  void Reset();
+
+ private:
+  static constexpr size_t BATCH = 256;  ///< Segments transformed per parallel batch
+
+  size_t Get_Hop() const { return std::max<size_t>(1, m_fft.Get_Size() / 2); }
+
+  /// Average the complete segments of the buffer.
+  void Process();
+
+  ChSensorFFT m_fft;
+  double m_sample_rate;
+  std::vector<double> m_window;
+  double m_window_power;
+  std::vector<double> m_buffer;  ///< Samples not yet covered by a complete segment
+  std::vector<double> m_sum;     ///< Sum of the periodograms
+  size_t m_segments;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSPECTRUM_H
@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORSTATISTICS_H
+#define CHRONO_SENSOR_CHSENSORSTATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "chrono_sensor/ChSensor.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Streaming statistics of a sensor or transform output, per component, in constant memory. The mean and variance
+/// are updated with Welford's method, which stays accurate over long runs where the naive sums cancel. Register it
+/// as an output callback of a sensor, or Add() the values of a transform directly. Statistics gathered in parallel
+/// are combined with Merge().
+template<class T>
+class ChSensorStatistics : public ChSensor<T>::OutputCallback {
+ public:
+  ChSensorStatistics() { Reset(); }
+
+  void OnOutput(const ChSensorSample<T> &sample) override { Add(sample.value); }
+
+  void Add(const T &value) {
+    ++m_count;
+    for (size_t i = 0; i < DIM; ++i) {
+      double x = Component(value, i);
+      double delta = x - m_mean[i];
+      m_mean[i] += delta / m_count;
+      m_m2[i] += delta * (x - m_mean[i]);
+      m_min[i] = std::min(m_min[i], x);
+      m_max[i] = std::max(m_max[i], x);
+    }
+  }
+
+  /// Combine with statistics of other values (Chan et al.).
+  void Merge(const ChSensorStatistics<T> &other) {
+    if (other.m_count == 0)
+      return;
+    size_t count = m_count + other.m_count;
+    for (size_t i = 0; i < DIM; ++i) {
+      double delta = other.m_mean[i] - m_mean[i];
+      m_mean[i] += delta * other.m_count / count;
+      m_m2[i] += other.m_m2[i] + delta * delta * m_count * other.m_count / count;
+      m_min[i] = std::min(m_min[i], other.m_min[i]);
+      m_max[i] = std::max(m_max[i], other.m_max[i]);
+    }
+    m_count = count;
+  }
+
+  size_t Get_Count() const { return m_count; }
+
+  T Get_Mean() const { return Get_Value(m_mean); }
+
+  /// Unbiased sample variance, 0 for less than two values.
+  T Get_Variance() const {
+    T variance = T(0.);
+    if (m_count > 1) {
+      for (size_t i = 0; i < DIM; ++i) {
+        Component(variance, i) = m_m2[i] / (m_count - 1);
+      }
+    }
+    return variance;
+  }
+
+  T Get_Stddev() const {
+    T stddev = Get_Variance();
+    for (size_t i = 0; i < DIM; ++i) {
+      Component(stddev, i) = std::sqrt(Component(stddev, i));
+    }
+    return stddev;
+  }
+
+  T Get_Min() const { return Get_Value(m_min); }
+
+  T Get_Max() const { return Get_Value(m_max); }
+
+  void Reset() {
+    m_count = 0;
+    std::fill(m_mean, m_mean + DIM, 0.);
+    std::fill(m_m2, m_m2 + DIM, 0.);
+    std::fill(m_min, m_min + DIM, std::numeric_limits<double>::infinity());
+    std::fill(m_max, m_max + DIM, -std::numeric_limits<double>::infinity());
+  }
+
+ private:
+  static constexpr size_t DIM = std::is_same<T, double>::value ? 1 : (std::is_same<T, ChVector<>>::value ? 3 : 4);
+
+  static double &Component(T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static double Component(const T &x, const size_t c) {
+    if constexpr(std::is_same<T, double>::value) {
+      return x;
+    } else {
+      return x[c];
+    }
+  }
+
+  static T Get_Value(const double *components) {
+    T value = T(0.);
+    for (size_t i = 0; i < DIM; ++i) {
+      Component(value, i) = components[i];
+    }
+    return value;
+  }
+
+  size_t m_count;
+  double m_mean[DIM];
+  double m_m2[DIM];
+  double m_min[DIM];
+  double m_max[DIM];
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORSTATISTICS_H
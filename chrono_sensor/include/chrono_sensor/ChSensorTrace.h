@@ -0,0 +1,123 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_CHSENSORTRACE_H
+#define CHRONO_SENSOR_CHSENSORTRACE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "chrono/motion_functions/ChFunction_Recorder.h"
+#include "chrono_vehicle/ChApiVehicle.h"
+#include "chrono_sensor/ChSensorBuffer.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Curve of a trace exported to a recorder.
+enum TraceCurve {
+  TRACE_MEAN,     ///< Mean of each bucket
+  TRACE_MIN,      ///< Minimum of each bucket
+  TRACE_MAX,      ///< Maximum of each bucket
+  TRACE_ENVELOPE  ///< Minimum and maximum of each bucket at their instants, preserving the peaks of the signal
+};
+
+/// Streaming recorder of a scalar signal for plotting very long runs in bounded memory. Level 0 keeps the most
+/// recent samples at full resolution, each coarser level keeps min/max/mean buckets of twice the width, and the
+/// coarsest level covers the whole run, halving its own resolution when full. The memory is fixed by the capacity
+/// per level and the number of levels. Exports pick the finest level covering the requested interval at the
+/// requested number of points, so their cost is proportional to the number of output points.
+class CH_VEHICLE_API ChSensorTrace {
+ public:
+  /// Aggregate of consecutive samples.
+  struct Bucket {
+    double t_start;  ///< Time of the first sample
+    double t_end;    ///< Time of the last sample
+    double t_min;    ///< Time of the minimum
+    double t_max;    ///< Time of the maximum
+    double min;
+    double max;
+    double sum;
+    size_t count;
+
+    double Get_Mean() const { return sum / count; }
+  };
+
+  /// Keep the given (even) number of buckets per level, over at most the given number of levels.
+  explicit ChSensorTrace(size_t capacity = 4096, size_t max_levels = 16);
+
+  /// Add a sample, in time order.
+  void Add(double time, double value);
+
+  /// Return at most the given number of buckets over [t_start, t_end], oldest first. The default interval is the
+  /// whole run.
+  std::vector<Bucket> Get_Buckets(size_t points, double t_start = -1e300, double t_end = 1e300) const;
+
+  /// Write time, mean, minimum, maximum and count columns, one bucket per line, as read by gnuplot or a CSV reader.
+  void Write(std::ostream &out, size_t points, const std::string &delimiter = "\t", double t_start = -1e300,
+             double t_end = 1e300) const;
+
+  /// Fill a recorder with one curve of the trace, e.g. to plot it with ChGnuPlot.
+  void Fill_Recorder(ChFunction_Recorder &recorder, size_t points, TraceCurve curve = TRACE_ENVELOPE,
+                     double t_start = -1e300, double t_end = 1e300) const;
+
+  /// Number of samples added since the start of the run.
+  size_t Get_Count() const { return m_count; }
+
+  size_t Get_Levels() const { return m_levels.size(); }
+
+  size_t Get_Capacity() const { return m_capacity; }
+
+  void Clear();
+
+ private:
+  struct Level {
+    ChSensorBuffer<Bucket> buckets;
+    Bucket pending;
+    size_t pending_count;
+    size_t span;   ///< Number of buckets of the finer level merged per bucket
+    bool evicted;  ///< Whether the oldest buckets were dropped, to the coarser level
+  };
+
+  static Bucket Merge(const Bucket &a, const Bucket &b);
+
+  void Push(size_t level, const Bucket &bucket);
+
+  void Carry(size_t level, const Bucket &bucket);
+
+  void Add_Level(const Level &finer);
+
+  static void Compact(Level &level);
+
+  size_t m_capacity;
+  size_t m_max_levels;
+  size_t m_count;
+  std::vector<Level> m_levels;
+};
+
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_CHSENSORTRACE_H
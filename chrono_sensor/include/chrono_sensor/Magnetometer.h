@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef CHRONO_SENSOR_MAGNETOMETER_H
+#define CHRONO_SENSOR_MAGNETOMETER_H
+
+#include "ChSensor.h"
+#include "chrono_sensor/ChFunction_SensorNoise.h"
+#include "chrono_sensor/ChFunction_SensorDigitize.h"
+#include "chrono_sensor/ChMagneticFieldGrid.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+/// Three axis magnetometer, measuring the magnetic field in the vehicle reference frame.
+/// The field is looked up in a precomputed grid, which may be shared between sensors.
+class CH_VEHICLE_API Magnetometer : public ChSensor<ChVector<>> {
+ public:
+  Magnetometer(ChVehicle &vehicle, const double sample_rate, const double delay);
+
+  /// Magnetometer that isn't mounted on a vehicle; its pose is given to Synchronize(time, pos, rot).
+  Magnetometer(const double sample_rate, const double delay);
+
+  void Initialize(std::shared_ptr<ChMagneticFieldGrid> field,
+                  const double &bits,
+                  const ChVector<> &range,
+                  const ChVector<> &mean,
+                  const ChVector<> &stddev);
+
+  void Synchronize(double time) override;
+
+  /// Synchronize with the sensor at the given world position and orientation.
+  void Synchronize(double time, const ChVector<> &pos, const ChQuaternion<> &rot);
+
+  std::shared_ptr<ChMagneticFieldGrid> Get_Field() const { return m_field; }
+
+  std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> Get_DigitalTransform();
+  std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> Get_NoiseTransform();
+
+ private:
+  std::shared_ptr<ChMagneticFieldGrid> m_field;
+  std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> m_noise;
+  std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> m_digitize;
+};
+} /// sensor
+} /// vehicle
+} /// chrono
+#endif //CHRONO_SENSOR_MAGNETOMETER_H
@@ -31,29 +31,29 @@ Accelerometer::Accelerometer(ChVehicle &vehicle, const double sample_rate, const
     vehicle,
     sample_rate,
     delay) {
-  auto noise = std::make_shared<ChFunction_SensorNoise<ChVector<>>>();
-  auto digitize = std::make_shared<ChFunction_SensorDigitize<ChVector<>>>();
-  m_transform.push_back(noise);
-  m_transform.push_back(digitize);
+  m_noise = std::make_shared<ChFunction_SensorNoise<ChVector<>>>();
+  m_digitize = std::make_shared<ChFunction_SensorDigitize<ChVector<>>>();
+  m_transform.push_back(m_noise);
+  m_transform.push_back(m_digitize);
 }
 
 void Accelerometer::Initialize(const double &bits,
                                const ChVector<> &range,
                                const ChVector<> &mean,
                                const ChVector<> &stddev) {
-  Get_DigitalTransform()->Set_Bits(bits);
-  Get_DigitalTransform()->Set_Range(range);
-  Get_NoiseTransform()->Set_Mean(mean);
-  Get_NoiseTransform()->Set_Stddev(stddev);
+  m_digitize->Set_Bits(bits);
+  m_digitize->Set_Range(range);
+  m_noise->Set_Mean(mean);
+  m_noise->Set_Stddev(stddev);
   ChSensor::Initialize();
 }
 
 std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> Accelerometer::Get_DigitalTransform() {
-  return std::dynamic_pointer_cast<ChFunction_SensorDigitize<ChVector<>>>(m_transform[1]);
+  return m_digitize;
 }
 
 std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> Accelerometer::Get_NoiseTransform() {
-  return std::dynamic_pointer_cast<ChFunction_SensorNoise<ChVector<>>>(m_transform[0]);
+  return m_noise;
 }
 } /// sensor
 } /// vehicle
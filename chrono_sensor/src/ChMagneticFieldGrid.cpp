@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "chrono_sensor/ChMagneticFieldGrid.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+namespace {
+const char GRID_MAGIC[4] = {'C', 'H', 'M', 'G'};
+const int32_t GRID_VERSION = 1;
+}
+
+ChMagneticFieldGrid::ChMagneticFieldGrid() : m_min(0.), m_max(0.), m_inv_spacing(0.), m_dim{1, 1, 1}, m_hash(0) {
+  m_field.assign(3, 0.);
+}
+
+bool ChMagneticFieldGrid::Initialize(const ChMagneticFieldModel &model,
+                                     const ChVector<> &min,
+                                     const ChVector<> &max,
+                                     const double spacing,
+                                     const std::string &cache_filename) {
+  if (!(spacing > 0.) || !(min.x() <= max.x() && min.y() <= max.y() && min.z() <= max.z()))
+    return false;
+
+  m_hash = model.Get_Hash();
+  m_min = min;
+  m_max = max;
+  for (int d = 0; d < 3; ++d) {
+    double length = max[d] - min[d];
+    m_dim[d] = std::max(2, static_cast<int>(std::ceil(length / spacing)) + 1);
+    m_inv_spacing[d] = length > 0. ? (m_dim[d] - 1) / length : 0.;
+  }
+
+  if (!cache_filename.empty()) {
+    ChMagneticFieldGrid cached;
+    if (cached.Load(cache_filename, m_hash) && cached.m_min == m_min && cached.m_max == m_max
+        && cached.m_dim == m_dim) {
+      *this = std::move(cached);
+      return true;
+    }
+  }
+
+  m_field.assign(3 * static_cast<size_t>(m_dim[0]) * m_dim[1] * m_dim[2], 0.);
+#pragma omp parallel for
+  for (int k = 0; k < m_dim[2]; ++k) {
+    for (int j = 0; j < m_dim[1]; ++j) {
+      for (int i = 0; i < m_dim[0]; ++i) {
+        ChVector<> pos(m_dim[0] > 1 ? min.x() + i * (max.x() - min.x()) / (m_dim[0] - 1) : min.x(),
+                       m_dim[1] > 1 ? min.y() + j * (max.y() - min.y()) / (m_dim[1] - 1) : min.y(),
+                       m_dim[2] > 1 ? min.z() + k * (max.z() - min.z()) / (m_dim[2] - 1) : min.z());
+        ChVector<> field = model.Get_Field(pos);
+        size_t n = Index(i, j, k);
+        m_field[n] = field.x();
+        m_field[n + 1] = field.y();
+        m_field[n + 2] = field.z();
+      }
+    }
+  }
+
+  if (!cache_filename.empty())
+    Save(cache_filename);
+  return true;
+}
+
+ChVector<> ChMagneticFieldGrid::Get_Field(const ChVector<> &pos) const {
+  int idx[3];
+  double frac[3];
+  for (int d = 0; d < 3; ++d) {
+    double u = (pos[d] - m_min[d]) * m_inv_spacing[d];
+    u = std::min(std::max(u, 0.), static_cast<double>(m_dim[d] - 1));
+    idx[d] = std::min(static_cast<int>(u), m_dim[d] - 2);
+    idx[d] = std::max(idx[d], 0);
+    frac[d] = u - idx[d];
+  }
+
+  // Strides to the neighbouring nodes; degenerate (single node) axes don't advance
+  size_t sx = m_dim[0] > 1 ? 3 : 0;
+  size_t sy = m_dim[1] > 1 ? 3 * static_cast<size_t>(m_dim[0]) : 0;
+  size_t sz = m_dim[2] > 1 ? 3 * static_cast<size_t>(m_dim[0]) * m_dim[1] : 0;
+  const double *c = m_field.data() + Index(idx[0], idx[1], idx[2]);
+
+  double ret[3];
+  for (int d = 0; d < 3; ++d) {
+    double c00 = c[d] + frac[0] * (c[sx + d] - c[d]);
+    double c10 = c[sy + d] + frac[0] * (c[sy + sx + d] - c[sy + d]);
+    double c01 = c[sz + d] + frac[0] * (c[sz + sx + d] - c[sz + d]);
+    double c11 = c[sz + sy + d] + frac[0] * (c[sz + sy + sx + d] - c[sz + sy + d]);
+    double c0 = c00 + frac[1] * (c10 - c00);
+    double c1 = c01 + frac[1] * (c11 - c01);
+    ret[d] = c0 + frac[2] * (c1 - c0);
+  }
+  return ChVector<>(ret[0], ret[1], ret[2]);
+}
+
+bool ChMagneticFieldGrid::Save(const std::string &filename) const {
+  std::ofstream ofile(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!ofile)
+    return false;
+
+  double box[6] = {m_min.x(), m_min.y(), m_min.z(), m_max.x(), m_max.y(), m_max.z()};
+  ofile.write(GRID_MAGIC, sizeof(GRID_MAGIC));
+  ofile.write(reinterpret_cast<const char *>(&GRID_VERSION), sizeof(GRID_VERSION));
+  ofile.write(reinterpret_cast<const char *>(&m_hash), sizeof(m_hash));
+  ofile.write(reinterpret_cast<const char *>(box), sizeof(box));
+  ofile.write(reinterpret_cast<const char *>(m_dim.data()), sizeof(int) * m_dim.size());
+  ofile.write(reinterpret_cast<const char *>(m_field.data()), sizeof(double) * m_field.size());
+  return static_cast<bool>(ofile);
+}
+
+bool ChMagneticFieldGrid::Load(const std::string &filename, const uint64_t hash) {
+  std::ifstream ifile(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!ifile)
+    return false;
+
+  char magic[4];
+  int32_t version;
+  uint64_t file_hash;
+  double box[6];
+  std::array<int, 3> dim;
+  ifile.read(magic, sizeof(magic));
+  ifile.read(reinterpret_cast<char *>(&version), sizeof(version));
+  ifile.read(reinterpret_cast<char *>(&file_hash), sizeof(file_hash));
+  ifile.read(reinterpret_cast<char *>(box), sizeof(box));
+  ifile.read(reinterpret_cast<char *>(dim.data()), sizeof(int) * dim.size());
+  if (!ifile || !std::equal(magic, magic + 4, GRID_MAGIC) || version != GRID_VERSION || file_hash != hash
+      || dim[0] < 1 || dim[1] < 1 || dim[2] < 1)
+    return false;
+
+  std::vector<double> field(3 * static_cast<size_t>(dim[0]) * dim[1] * dim[2]);
+  ifile.read(reinterpret_cast<char *>(field.data()), sizeof(double) * field.size());
+  if (!ifile)
+    return false;
+
+  m_hash = file_hash;
+  m_min = ChVector<>(box[0], box[1], box[2]);
+  m_max = ChVector<>(box[3], box[4], box[5]);
+  m_dim = dim;
+  for (int d = 0; d < 3; ++d) {
+    double length = m_max[d] - m_min[d];
+    m_inv_spacing[d] = length > 0. ? (m_dim[d] - 1) / length : 0.;
+  }
+  m_field = std::move(field);
+  return true;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,180 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "chrono/core/ChMathematics.h"
+#include "chrono_sensor/ChMagneticFieldModel.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+namespace {
+// Geomagnetic reference radius [m]
+const double EARTH_RADIUS = 6371200.;
+
+void hash_combine(uint64_t &hash, const void *data, const size_t size) {
+  // FNV-1a
+  auto bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+}
+
+ChMagneticFieldSH::ChMagneticFieldSH() : m_latitude(0.), m_longitude(0.), m_altitude(0.) {
+  Set_Degree(1);
+  Set_Coefficient(1, 0, -29404.8, 0.);
+  Set_Coefficient(1, 1, -1450.9, 4652.5);
+}
+
+void ChMagneticFieldSH::Set_Origin(const double latitude, const double longitude, const double altitude) {
+  m_latitude = latitude;
+  m_longitude = longitude;
+  m_altitude = altitude;
+}
+
+void ChMagneticFieldSH::Set_Degree(const int degree) {
+  m_degree = degree;
+  m_g.assign(Index(degree, degree) + 1, 0.);
+  m_h.assign(Index(degree, degree) + 1, 0.);
+}
+
+void ChMagneticFieldSH::Set_Coefficient(const int n, const int m, const double g, const double h) {
+  if (n < 1 || n > m_degree || m < 0 || m > n)
+    return;
+  m_g[Index(n, m)] = g;
+  m_h[Index(n, m)] = h;
+}
+
+bool ChMagneticFieldSH::Load(const std::string &filename) {
+  std::ifstream ifile(filename.c_str());
+  if (!ifile)
+    return false;
+
+  std::vector<int> n_v, m_v;
+  std::vector<double> g_v, h_v;
+  int degree = 0;
+  std::string line;
+  while (std::getline(ifile, line)) {
+    std::istringstream iss(line);
+    int n, m;
+    double g, h;
+    // Header and trailer lines of the WMM format don't parse as n m g h
+    if (!(iss >> n >> m >> g >> h) || n < 1 || m < 0 || m > n)
+      continue;
+    n_v.push_back(n);
+    m_v.push_back(m);
+    g_v.push_back(g);
+    h_v.push_back(h);
+    degree = std::max(degree, n);
+  }
+  if (degree == 0)
+    return false;
+
+  Set_Degree(degree);
+  for (size_t i = 0; i < n_v.size(); ++i) {
+    Set_Coefficient(n_v[i], m_v[i], g_v[i], h_v[i]);
+  }
+  return true;
+}
+
+ChVector<> ChMagneticFieldSH::Get_Field(const ChVector<> &pos) const {
+  // Map the local ENU position onto geocentric spherical coordinates
+  double r0 = EARTH_RADIUS + m_altitude;
+  double theta = (90. - m_latitude) * CH_C_DEG_TO_RAD - pos.y() / r0;
+  double sin_theta0 = std::max(std::abs(std::sin(theta)), 1e-9);
+  double phi = m_longitude * CH_C_DEG_TO_RAD + pos.x() / (r0 * sin_theta0);
+  double r = r0 + pos.z();
+
+  double cos_t = std::cos(theta);
+  double sin_t = std::sin(theta);
+  if (std::abs(sin_t) < 1e-9)
+    sin_t = std::copysign(1e-9, sin_t);
+
+  // Schmidt semi-normalized associated Legendre functions and their theta derivatives
+  size_t size = Index(m_degree, m_degree) + 1;
+  std::vector<double> P(size, 0.);
+  std::vector<double> dP(size, 0.);
+  P[0] = 1.;
+  for (int n = 1; n <= m_degree; ++n) {
+    for (int m = 0; m <= n; ++m) {
+      size_t i = Index(n, m);
+      if (n == m) {
+        size_t j = Index(n - 1, n - 1);
+        double k = n == 1 ? 1. : std::sqrt((2. * n - 1.) / (2. * n));
+        P[i] = k * sin_t * P[j];
+        dP[i] = k * (sin_t * dP[j] + cos_t * P[j]);
+      } else {
+        size_t j = Index(n - 1, m);
+        double k = std::sqrt(static_cast<double>(n * n - m * m));
+        double l = n - 2 >= m ? std::sqrt(static_cast<double>((n - 1) * (n - 1) - m * m)) : 0.;
+        double P_2 = n - 2 >= m ? P[Index(n - 2, m)] : 0.;
+        double dP_2 = n - 2 >= m ? dP[Index(n - 2, m)] : 0.;
+        P[i] = ((2. * n - 1.) * cos_t * P[j] - l * P_2) / k;
+        dP[i] = ((2. * n - 1.) * (cos_t * dP[j] - sin_t * P[j]) - l * dP_2) / k;
+      }
+    }
+  }
+
+  double B_r = 0.;
+  double B_theta = 0.;
+  double B_phi = 0.;
+  double ratio = EARTH_RADIUS / r;
+  double ratio_n = ratio * ratio;
+  for (int n = 1; n <= m_degree; ++n) {
+    ratio_n *= ratio;
+    for (int m = 0; m <= n; ++m) {
+      size_t i = Index(n, m);
+      double cos_mp = std::cos(m * phi);
+      double sin_mp = std::sin(m * phi);
+      double gh = m_g[i] * cos_mp + m_h[i] * sin_mp;
+      B_r += ratio_n * (n + 1) * gh * P[i];
+      B_theta -= ratio_n * gh * dP[i];
+      B_phi += ratio_n * m * (m_g[i] * sin_mp - m_h[i] * cos_mp) * P[i] / sin_t;
+    }
+  }
+
+  // East, North, Up in Tesla
+  return ChVector<>(B_phi, -B_theta, B_r) * 1e-9;
+}
+
+uint64_t ChMagneticFieldSH::Get_Hash() const {
+  uint64_t hash = 14695981039346656037ULL;
+  hash_combine(hash, &m_degree, sizeof(m_degree));
+  hash_combine(hash, m_g.data(), m_g.size() * sizeof(double));
+  hash_combine(hash, m_h.data(), m_h.size() * sizeof(double));
+  hash_combine(hash, &m_latitude, sizeof(m_latitude));
+  hash_combine(hash, &m_longitude, sizeof(m_longitude));
+  hash_combine(hash, &m_altitude, sizeof(m_altitude));
+  return hash;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
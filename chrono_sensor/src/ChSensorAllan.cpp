@@ -0,0 +1,79 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <cmath>
+
+#include "chrono_sensor/ChSensorAllan.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+std::vector<ChAllanPoint> Allan_Deviation(const double *rate, size_t count, double tau0, size_t points_per_octave,
+                                          size_t stride) {
+  std::vector<ChAllanPoint> result;
+  if (count < 2 || tau0 <= 0.)
+    return result;
+  // Phase (integrated rate) at the sample boundaries, relative to the mean rate so the sums stay small
+  double mean = 0.;
+  for (size_t i = 0; i < count; ++i) {
+    mean += rate[i * stride];
+  }
+  mean /= count;
+  std::vector<double> phase(count + 1);
+  phase[0] = 0.;
+  for (size_t i = 0; i < count; ++i) {
+    phase[i + 1] = phase[i] + (rate[i * stride] - mean) * tau0;
+  }
+
+  // Cluster sizes spaced evenly on a logarithmic scale, at least one sample apart
+  points_per_octave = points_per_octave == 0 ? 1 : points_per_octave;
+  size_t previous = 0;
+  for (size_t k = 0;; ++k) {
+    auto m = static_cast<size_t>(std::floor(std::pow(2., static_cast<double>(k) / points_per_octave)));
+    if (m == previous)
+      continue;
+    previous = m;
+    if (2 * m > count)
+      break;
+    const double *x = phase.data();
+    long terms = static_cast<long>(count - 2 * m + 1);
+    double sum = 0.;
+#pragma omp parallel for reduction(+:sum) schedule(static)
+    for (long i = 0; i < terms; ++i) {
+      double d = x[i + 2 * m] - 2. * x[i + m] + x[i];
+      sum += d * d;
+    }
+    double tau = m * tau0;
+    result.push_back({tau, std::sqrt(sum / (2. * tau * tau * terms)), static_cast<size_t>(terms)});
+  }
+  return result;
+}
+
+std::vector<ChAllanPoint> Allan_Deviation(const std::vector<double> &rate, double tau0, size_t points_per_octave) {
+  return Allan_Deviation(rate.data(), rate.size(), tau0, points_per_octave, 1);
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
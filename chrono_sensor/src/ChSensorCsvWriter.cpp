@@ -0,0 +1,184 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "chrono_sensor/ChSensorCsvWriter.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+namespace {
+/// Longest formatted double, e.g. -1.2345678901234567e-308
+const size_t MAX_NUMBER = 32;
+}
+
+ChSensorCsvWriter::ChSensorCsvWriter(size_t block_size, double flush_interval)
+    : m_size(0),
+      m_block_size(block_size),
+      m_flush_interval(flush_interval),
+      m_last_flush(std::chrono::steady_clock::now()),
+      m_precision(6),
+      m_delimiter(", "),
+      m_line_start(true),
+      m_bytes(0) {
+  m_buffer.resize(m_block_size + 4 * MAX_NUMBER);
+}
+
+ChSensorCsvWriter::~ChSensorCsvWriter() {
+  Close();
+}
+
+bool ChSensorCsvWriter::Open(const std::string &filename, bool append) {
+  Close();
+  m_file.open(filename.c_str(), std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+  m_size = 0;
+  m_bytes = 0;
+  m_line_start = true;
+  m_last_flush = std::chrono::steady_clock::now();
+  return m_file.is_open();
+}
+
+void ChSensorCsvWriter::Close() {
+  if (!m_file.is_open())
+    return;
+  Flush();
+  m_file.close();
+}
+
+void ChSensorCsvWriter::Set_Flush(size_t block_size, double flush_interval) {
+  Flush();
+  m_block_size = block_size;
+  m_flush_interval = flush_interval;
+  m_buffer.resize(m_block_size + 4 * MAX_NUMBER);
+}
+
+void ChSensorCsvWriter::Set_Precision(int Precision) {
+  // Longer outputs could exceed the MAX_NUMBER bytes reserved for a number
+  m_precision = std::min(std::max(Precision, 0), 17);
+}
+
+ChSensorCsvWriter &ChSensorCsvWriter::Write(double value) {
+  Begin_Field();
+  Append(value);
+  return *this;
+}
+
+ChSensorCsvWriter &ChSensorCsvWriter::Write(size_t value) {
+  Begin_Field();
+  if (m_buffer.size() - m_size < MAX_NUMBER)
+    Flush();
+  char *first = m_buffer.data() + m_size;
+  auto result = std::to_chars(first, m_buffer.data() + m_buffer.size(), value);
+  m_bytes += result.ptr - first;
+  m_size = result.ptr - m_buffer.data();
+  return *this;
+}
+
+ChSensorCsvWriter &ChSensorCsvWriter::Write(const ChVector<> &value) {
+  Begin_Field();
+  Append(value.x());
+  Append("  ", 2);
+  Append(value.y());
+  Append("  ", 2);
+  Append(value.z());
+  return *this;
+}
+
+ChSensorCsvWriter &ChSensorCsvWriter::Write(const ChQuaternion<> &value) {
+  Begin_Field();
+  Append(value.e0());
+  Append("  ", 2);
+  Append(value.e1());
+  Append("  ", 2);
+  Append(value.e2());
+  Append("  ", 2);
+  Append(value.e3());
+  return *this;
+}
+
+ChSensorCsvWriter &ChSensorCsvWriter::Write(const std::string &text) {
+  Begin_Field();
+  Append(text.data(), text.size());
+  return *this;
+}
+
+bool ChSensorCsvWriter::End_Line() {
+  Append("\n", 1);
+  m_line_start = true;
+  if (m_size >= m_block_size
+      || std::chrono::duration<double>(std::chrono::steady_clock::now() - m_last_flush).count() >= m_flush_interval)
+    return Flush();
+  return true;
+}
+
+bool ChSensorCsvWriter::Flush() {
+  m_last_flush = std::chrono::steady_clock::now();
+  if (!m_file.is_open()) {
+    m_size = 0;
+    return false;
+  }
+  if (m_size == 0)
+    return true;
+  m_file.write(m_buffer.data(), m_size);
+  m_file.flush();
+  m_size = 0;
+  return static_cast<bool>(m_file);
+}
+
+void ChSensorCsvWriter::Begin_Field() {
+  if (!m_line_start)
+    Append(m_delimiter.data(), m_delimiter.size());
+  m_line_start = false;
+}
+
+void ChSensorCsvWriter::Append(double value) {
+  if (m_buffer.size() - m_size < MAX_NUMBER)
+    Flush();
+  char *first = m_buffer.data() + m_size;
+  char *last = m_buffer.data() + m_buffer.size();
+  auto result = m_precision > 0 ? std::to_chars(first, last, value, std::chars_format::general, m_precision)
+                                : std::to_chars(first, last, value);
+  m_bytes += result.ptr - first;
+  m_size = result.ptr - m_buffer.data();
+}
+
+void ChSensorCsvWriter::Append(const char *text, size_t length) {
+  while (length > 0) {
+    if (m_size == m_buffer.size())
+      Flush();
+    size_t count = std::min(length, m_buffer.size() - m_size);
+    std::memcpy(m_buffer.data() + m_size, text, count);
+    m_size += count;
+    m_bytes += count;
+    text += count;
+    length -= count;
+  }
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "chrono_sensor/ChSensorDropout.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorDropout::ChSensorDropout(const double loss)
+    : ChSensorDropout(0., 1., loss, loss) {}
+
+ChSensorDropout::ChSensorDropout(const double p_good_bad,
+                                 const double p_bad_good,
+                                 const double loss_good,
+                                 const double loss_bad)
+    : m_p_good_bad(p_good_bad),
+      m_p_bad_good(p_bad_good),
+      m_loss_good(loss_good),
+      m_loss_bad(loss_bad),
+      m_bad(false),
+      m_gen(std::random_device()()),
+      m_uniform(0., 1.) {}
+
+bool ChSensorDropout::Is_Dropped() {
+  if (m_p_good_bad > 0. || m_bad) {
+    m_bad = m_uniform(m_gen) < (m_bad ? 1. - m_p_bad_good : m_p_good_bad);
+  }
+  double loss = m_bad ? m_loss_bad : m_loss_good;
+  return loss > 0. && m_uniform(m_gen) < loss;
+}
+
+void ChSensorDropout::SnapshotOut(ChSensorSnapshot &snapshot) const {
+  snapshot.Write(m_p_good_bad);
+  snapshot.Write(m_p_bad_good);
+  snapshot.Write(m_loss_good);
+  snapshot.Write(m_loss_bad);
+  snapshot.Write(m_bad);
+  snapshot.Write_Engine(m_gen);
+}
+
+bool ChSensorDropout::SnapshotIn(ChSensorSnapshot &snapshot) {
+  return snapshot.Read(m_p_good_bad) && snapshot.Read(m_p_bad_good) && snapshot.Read(m_loss_good)
+      && snapshot.Read(m_loss_bad) && snapshot.Read(m_bad) && snapshot.Read_Engine(m_gen);
+}
+
+double ChSensorDropout::Get_LossRate() const {
+  double switching = m_p_good_bad + m_p_bad_good;
+  if (switching <= 0.)
+    return m_bad ? m_loss_bad : m_loss_good;
+  // Stationary probability of the bad state
+  double bad = m_p_good_bad / switching;
+  return (1. - bad) * m_loss_good + bad * m_loss_bad;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
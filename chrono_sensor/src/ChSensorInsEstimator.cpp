@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "chrono_sensor/ChSensorInsEstimator.h"
+#include "chrono_sensor/ChFunction_SensorOrientationNoise.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorInsEstimator::ChSensorInsEstimator()
+    : m_time(0.),
+      m_position(0.),
+      m_velocity(0.),
+      m_orientation(1., 0., 0., 0.),
+      m_acceleration(0.),
+      m_angular_velocity(0.),
+      m_gravity(0.),
+      m_acceleration_noise(0.1),
+      m_angular_velocity_noise(0.01) {}
+
+void ChSensorInsEstimator::Initialize(double time, const ChVector<> &position, const ChVector<> &velocity,
+                                      const ChQuaternion<> &orientation, double position_stddev,
+                                      double velocity_stddev, double orientation_stddev) {
+  m_time = time;
+  m_position = position;
+  m_velocity = velocity;
+  m_orientation = orientation.GetNormalized();
+  ChSensorKalman<N>::Covariance P;
+  for (int i = 0; i < 3; ++i) {
+    P(i, i) = position_stddev * position_stddev;
+    P(3 + i, 3 + i) = velocity_stddev * velocity_stddev;
+    P(6 + i, 6 + i) = orientation_stddev * orientation_stddev;
+  }
+  m_filter.Set_Covariance(P);
+}
+
+void ChSensorInsEstimator::Set_ProcessNoise(double acceleration_noise, double angular_velocity_noise) {
+  m_acceleration_noise = acceleration_noise;
+  m_angular_velocity_noise = angular_velocity_noise;
+}
+
+void ChSensorInsEstimator::Set_Acceleration(double time, const ChVector<> &acceleration) {
+  Propagate(time);
+  m_acceleration = acceleration;
+}
+
+void ChSensorInsEstimator::Set_AngularVelocity(double time, const ChVector<> &angular_velocity) {
+  Propagate(time);
+  m_angular_velocity = angular_velocity;
+}
+
+void ChSensorInsEstimator::Propagate(double time) {
+  double dt = time - m_time;
+  if (!(dt > 0.))
+    return;
+  auto identity = ChSensorMatrix<3, 3>::Identity();
+  ChSensorMatrix<3, 3> rotation = Rotation(m_orientation);
+  ChQuaternion<> increment = ChFunction_SensorOrientationNoise::Exp_Map(m_angular_velocity * dt);
+
+  // Error state transition, first order in the step
+  ChSensorKalman<N>::Covariance F = ChSensorKalman<N>::Covariance::Identity();
+  F.Set_Block(0, 3, identity * dt);
+  F.Set_Block(3, 6, rotation * Skew(m_acceleration) * -dt);
+  F.Set_Block(6, 6, Rotation(increment).Transpose());
+  ChSensorKalman<N>::Covariance Q;
+  double q_v = m_acceleration_noise * m_acceleration_noise * dt;
+  double q_theta = m_angular_velocity_noise * m_angular_velocity_noise * dt;
+  for (int i = 0; i < 3; ++i) {
+    Q(3 + i, 3 + i) = q_v;
+    Q(6 + i, 6 + i) = q_theta;
+  }
+  m_filter.Predict(F, Q);
+
+  // Nominal state
+  ChVector<> acceleration = m_orientation.Rotate(m_acceleration) + m_gravity;
+  m_position += m_velocity * dt + acceleration * (0.5 * dt * dt);
+  m_velocity += acceleration * dt;
+  m_orientation = (m_orientation * increment).GetNormalized();
+  m_time = time;
+}
+
+bool ChSensorInsEstimator::Update_Position(double time, const ChVector<> &position, double stddev) {
+  Propagate(time);
+  double lag = m_time - time;
+  ChVector<> acceleration = m_orientation.Rotate(m_acceleration) + m_gravity;
+  ChVector<> current = position + m_velocity * lag + acceleration * (0.5 * lag * lag);
+  return Update(0, current - m_position, stddev);
+}
+
+bool ChSensorInsEstimator::Update_Velocity(double time, const ChVector<> &velocity, double stddev) {
+  Propagate(time);
+  double lag = m_time - time;
+  ChVector<> current = velocity + (m_orientation.Rotate(m_acceleration) + m_gravity) * lag;
+  return Update(3, current - m_velocity, stddev);
+}
+
+bool ChSensorInsEstimator::Update_Orientation(double time, const ChQuaternion<> &orientation, double stddev) {
+  Propagate(time);
+  double lag = m_time - time;
+  ChQuaternion<> current = orientation * ChFunction_SensorOrientationNoise::Exp_Map(m_angular_velocity * lag);
+  return Update(6, ChFunction_SensorOrientationNoise::Log_Map(m_orientation.GetConjugate() * current), stddev);
+}
+
+bool ChSensorInsEstimator::Update(int index, const ChVector<> &residual, double stddev) {
+  ChSensorMatrix<3, 1> z;
+  z.Set_Vector(0, residual);
+  ChSensorMatrix<3, N> H;
+  H.Set_Block(0, index, ChSensorMatrix<3, 3>::Identity());
+  ChSensorMatrix<3, 3> R = ChSensorMatrix<3, 3>::Identity() * (stddev * stddev);
+  ChSensorKalman<N>::State dx;
+  if (!m_filter.Update(z, H, R, dx))
+    return false;
+  m_position += dx.Get_Vector(0);
+  m_velocity += dx.Get_Vector(3);
+  m_orientation = (m_orientation * ChFunction_SensorOrientationNoise::Exp_Map(dx.Get_Vector(6))).GetNormalized();
+  return true;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
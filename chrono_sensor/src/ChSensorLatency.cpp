@@ -0,0 +1,58 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <cmath>
+
+#include "chrono_sensor/ChSensorLatency.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorLatency::ChSensorLatency(const LatencyDistribution distribution, const double scale)
+    : m_distribution(distribution), m_scale(scale), m_gen(std::random_device()()) {}
+
+double ChSensorLatency::Get_Latency() {
+  if (m_scale <= 0.)
+    return 0.;
+  switch (m_distribution) {
+    case LATENCY_UNIFORM:return std::uniform_real_distribution<double>(0., m_scale)(m_gen);
+    case LATENCY_NORMAL:return std::abs(std::normal_distribution<double>(0., m_scale)(m_gen));
+    case LATENCY_EXPONENTIAL:return std::exponential_distribution<double>(1. / m_scale)(m_gen);
+  }
+  return 0.;
+}
+
+void ChSensorLatency::SnapshotOut(ChSensorSnapshot &snapshot) const {
+  snapshot.Write(m_distribution);
+  snapshot.Write(m_scale);
+  snapshot.Write_Engine(m_gen);
+}
+
+bool ChSensorLatency::SnapshotIn(ChSensorSnapshot &snapshot) {
+  return snapshot.Read(m_distribution) && snapshot.Read(m_scale) && snapshot.Read_Engine(m_gen);
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,229 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <charconv>
+#include <cstring>
+
+#include "chrono_sensor/ChSensorLogReader.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+namespace {
+const char BINARY_MAGIC[4] = {'C', 'H', 'S', 'L'};
+
+std::string Trim(const std::string &text) {
+  size_t first = text.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+}
+
+ChSensorLogReader::ChSensorLogReader()
+    : m_binary(false), m_run_length(false), m_skipped(0), m_run_count(0), m_run_next(0), m_run_step(0.),
+      m_run_timed(false) {}
+
+bool ChSensorLogReader::Open(const std::string &filename) {
+  Close();
+  m_file.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!m_file)
+    return false;
+
+  char magic[4];
+  if (m_file.read(magic, 4) && std::memcmp(magic, BINARY_MAGIC, 4) == 0) {
+    uint32_t version, columns;
+    m_file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    m_file.read(reinterpret_cast<char *>(&columns), sizeof(columns));
+    if (!m_file || version != BINARY_VERSION || columns == 0) {
+      Close();
+      return false;
+    }
+    m_binary = true;
+    for (uint32_t i = 0; i < columns; ++i) {
+      m_names.push_back("Column[" + std::to_string(i) + "]");
+    }
+    return true;
+  }
+
+  // CSV: optional header, then the first row fixes the columns
+  m_file.clear();
+  m_file.seekg(0);
+  std::string line;
+  std::vector<std::string> header;
+  std::vector<size_t> fields;
+  while (std::getline(m_file, line)) {
+    if (Parse_Line(line, m_first, &fields))
+      break;
+    if (header.empty()) {
+      size_t start = 0;
+      for (size_t end; (end = line.find(',', start)) != std::string::npos; start = end + 1) {
+        header.push_back(Trim(line.substr(start, end - start)));
+      }
+      header.push_back(Trim(line.substr(start)));
+    }
+  }
+  if (m_first.empty()) {
+    Close();
+    return false;
+  }
+  // The run lengths of LOG_ON_CHANGE are expanded instead of returned as a column
+  m_run_length = header.size() == fields.size() && fields.size() > 1 && header.back() == "Count" && fields.back() == 1;
+  if (m_run_length)
+    fields.pop_back();
+  for (size_t f = 0; f < fields.size(); ++f) {
+    std::string name = f < header.size() ? header[f] : "Column";
+    if (fields[f] == 1) {
+      m_names.push_back(name);
+    } else {
+      for (size_t c = 0; c < fields[f]; ++c) {
+        m_names.push_back(name + "[" + std::to_string(c) + "]");
+      }
+    }
+  }
+  return true;
+}
+
+void ChSensorLogReader::Close() {
+  if (m_file.is_open())
+    m_file.close();
+  m_file.clear();
+  m_binary = false;
+  m_run_length = false;
+  m_names.clear();
+  m_first.clear();
+  m_skipped = 0;
+  m_run.clear();
+  m_following.clear();
+  m_run_count = 0;
+  m_run_next = 0;
+  m_run_step = 0.;
+  m_run_timed = false;
+}
+
+size_t ChSensorLogReader::Read(std::vector<double> &rows, size_t max_rows) {
+  rows.clear();
+  size_t columns = m_names.size();
+  if (!m_file.is_open() || columns == 0 || max_rows == 0)
+    return 0;
+  if (m_binary) {
+    rows.resize(max_rows * columns);
+    m_file.read(reinterpret_cast<char *>(rows.data()), rows.size() * sizeof(double));
+    size_t count = static_cast<size_t>(m_file.gcount()) / (columns * sizeof(double));
+    rows.resize(count * columns);
+    return count;
+  }
+  rows.reserve(max_rows * columns);
+  size_t count = 0;
+  std::vector<double> values;
+  while (count < max_rows) {
+    if (!m_run_length) {
+      if (!Next_Row(values))
+        break;
+      rows.insert(rows.end(), values.begin(), values.end());
+      ++count;
+    } else if (m_run_next < m_run_count) {
+      if (!m_run_timed) {
+        // The calls of a run are spaced evenly up to the next run; the last run keeps the previous spacing
+        if (Next_Row(m_following))
+          m_run_step = (m_following[0] - m_run[0]) / m_run_count;
+        m_run_timed = true;
+      }
+      rows.insert(rows.end(), m_run.begin(), m_run.end() - 1);
+      rows[rows.size() - columns] = m_run[0] + m_run_next * m_run_step;
+      ++m_run_next;
+      ++count;
+    } else {
+      if (!m_following.empty()) {
+        m_run.swap(m_following);
+        m_following.clear();
+      } else if (!Next_Row(m_run)) {
+        break;
+      }
+      m_run_count = m_run.back() >= 1. ? static_cast<size_t>(m_run.back()) : 1;
+      m_run_next = 0;
+      m_run_timed = false;
+    }
+  }
+  return count;
+}
+
+bool ChSensorLogReader::Next_Row(std::vector<double> &values) {
+  if (!m_first.empty()) {
+    values.swap(m_first);
+    m_first.clear();
+    return true;
+  }
+  size_t width = m_names.size() + m_run_length;
+  std::string line;
+  while (std::getline(m_file, line)) {
+    if (Parse_Line(line, values, nullptr) && values.size() == width)
+      return true;
+    m_skipped += !Trim(line).empty();
+  }
+  return false;
+}
+
+void ChSensorLogReader::Write_BinaryHeader(std::ostream &out, uint32_t columns) {
+  uint32_t version = BINARY_VERSION;
+  out.write(BINARY_MAGIC, 4);
+  out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+  out.write(reinterpret_cast<const char *>(&columns), sizeof(columns));
+}
+
+bool ChSensorLogReader::Parse_Line(const std::string &line, std::vector<double> &values, std::vector<size_t> *fields) {
+  values.clear();
+  if (fields)
+    fields->clear();
+  const char *p = line.data();
+  const char *end = p + line.size();
+  size_t components = 0;
+  while (true) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+      ++p;
+    if (p == end || *p == ',') {
+      // End of a field
+      if (components == 0)
+        return false;
+      if (fields)
+        fields->push_back(components);
+      components = 0;
+      if (p == end)
+        return true;
+      ++p;
+      continue;
+    }
+    double value;
+    auto result = std::from_chars(p + (*p == '+'), end, value);
+    if (result.ec != std::errc())
+      return false;
+    values.push_back(value);
+    ++components;
+    p = result.ptr;
+  }
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,198 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <cmath>
+
+#include "chrono_sensor/ChSensorMahony.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorMahony::ChSensorMahony(double kp, double ki)
+    : m_kp(kp), m_ki(ki), m_orientation(1., 0., 0., 0.), m_integral(0.) {}
+
+void ChSensorMahony::Set_Gains(double kp, double ki) {
+  m_kp = kp;
+  m_ki = ki;
+}
+
+void ChSensorMahony::Update(double dt, const ChVector<> &angular_velocity, const ChVector<> &acceleration) {
+  ChVector<> error(0.);
+  double norm = acceleration.Length();
+  if (norm > 0.) {
+    // Measured against predicted up direction in the body frame
+    ChVector<> up = m_orientation.RotateBack(ChVector<>(0., 0., 1.));
+    error = (acceleration / norm) % up;
+  }
+  Correct(dt, angular_velocity, error);
+}
+
+void ChSensorMahony::Update(double dt, const ChVector<> &angular_velocity, const ChVector<> &acceleration,
+                            const ChVector<> &magnetic_field) {
+  ChVector<> error(0.);
+  double norm = acceleration.Length();
+  if (norm > 0.) {
+    ChVector<> up = m_orientation.RotateBack(ChVector<>(0., 0., 1.));
+    error = (acceleration / norm) % up;
+  }
+  norm = magnetic_field.Length();
+  if (norm > 0.) {
+    // Field rotated to the world frame, made horizontal along X, and predicted back in the body frame
+    ChVector<> m = magnetic_field / norm;
+    ChVector<> h = m_orientation.Rotate(m);
+    ChVector<> b(std::sqrt(h.x() * h.x() + h.y() * h.y()), 0., h.z());
+    error += m % m_orientation.RotateBack(b);
+  }
+  Correct(dt, angular_velocity, error);
+}
+
+void ChSensorMahony::Correct(double dt, const ChVector<> &angular_velocity, const ChVector<> &error) {
+  m_integral += error * (m_ki * dt);
+  ChVector<> w = angular_velocity + error * m_kp + m_integral;
+  m_orientation += m_orientation * ChQuaternion<>(0., w) * (0.5 * dt);
+  m_orientation.Normalize();
+}
+
+ChSensorMahonyBank::ChSensorMahonyBank(size_t count, double kp, double ki) : m_kp(kp), m_ki(ki) {
+  Resize(count);
+}
+
+void ChSensorMahonyBank::Resize(size_t count) {
+  m_q[0].resize(count, 1.);
+  for (int c = 1; c < 4; ++c)
+    m_q[c].resize(count, 0.);
+  for (auto &component : m_integral)
+    component.resize(count, 0.);
+  for (auto &component : m_input)
+    component.resize(count, 0.);
+}
+
+void ChSensorMahonyBank::Set_Gains(double kp, double ki) {
+  m_kp = kp;
+  m_ki = ki;
+}
+
+void ChSensorMahonyBank::Set_Orientation(size_t i, const ChQuaternion<> &orientation) {
+  ChQuaternion<> q = orientation.GetNormalized();
+  for (int c = 0; c < 4; ++c)
+    m_q[c][i] = q[c];
+}
+
+ChQuaternion<> ChSensorMahonyBank::Get_Orientation(size_t i) const {
+  return ChQuaternion<>(m_q[0][i], m_q[1][i], m_q[2][i], m_q[3][i]);
+}
+
+ChVector<> ChSensorMahonyBank::Get_Integral(size_t i) const {
+  return ChVector<>(m_integral[0][i], m_integral[1][i], m_integral[2][i]);
+}
+
+void ChSensorMahonyBank::Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax,
+                                const double *ay, const double *az) {
+  Update(dt, gx, gy, gz, ax, ay, az, nullptr, nullptr, nullptr, false);
+}
+
+void ChSensorMahonyBank::Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax,
+                                const double *ay, const double *az, const double *mx, const double *my,
+                                const double *mz) {
+  Update(dt, gx, gy, gz, ax, ay, az, mx, my, mz, true);
+}
+
+void ChSensorMahonyBank::Update(double dt, const ChVector<> *angular_velocity, const ChVector<> *acceleration) {
+  size_t n = Size();
+  for (size_t i = 0; i < n; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      m_input[c][i] = angular_velocity[i][c];
+      m_input[3 + c][i] = acceleration[i][c];
+    }
+  }
+  Update(dt, m_input[0].data(), m_input[1].data(), m_input[2].data(), m_input[3].data(), m_input[4].data(),
+         m_input[5].data(), nullptr, nullptr, nullptr, false);
+}
+
+void ChSensorMahonyBank::Update(double dt, const double *gx, const double *gy, const double *gz, const double *ax,
+                                const double *ay, const double *az, const double *mx, const double *my,
+                                const double *mz, bool magnetic) {
+  const long n = static_cast<long>(Size());
+  double *q0 = m_q[0].data();
+  double *q1 = m_q[1].data();
+  double *q2 = m_q[2].data();
+  double *q3 = m_q[3].data();
+  double *ix = m_integral[0].data();
+  double *iy = m_integral[1].data();
+  double *iz = m_integral[2].data();
+  const double kp = m_kp;
+  const double ki_dt = m_ki * dt;
+  const double half_dt = 0.5 * dt;
+#pragma omp simd
+  for (long i = 0; i < n; ++i) {
+    double w = q0[i], x = q1[i], y = q2[i], z = q3[i];
+    // Up direction predicted in the body frame, the third row of the rotation matrix
+    double ux = 2. * (x * z - w * y);
+    double uy = 2. * (y * z + w * x);
+    double uz = 1. - 2. * (x * x + y * y);
+    double norm = std::sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+    double inv = norm > 0. ? 1. / norm : 0.;
+    double mx_a = ax[i] * inv, my_a = ay[i] * inv, mz_a = az[i] * inv;
+    double ex = my_a * uz - mz_a * uy;
+    double ey = mz_a * ux - mx_a * uz;
+    double ez = mx_a * uy - my_a * ux;
+    if (magnetic) {
+      double m_norm = std::sqrt(mx[i] * mx[i] + my[i] * my[i] + mz[i] * mz[i]);
+      double m_inv = m_norm > 0. ? 1. / m_norm : 0.;
+      double bx_m = mx[i] * m_inv, by_m = my[i] * m_inv, bz_m = mz[i] * m_inv;
+      // Field in the world frame, R m
+      double hx = (1. - 2. * (y * y + z * z)) * bx_m + 2. * (x * y - w * z) * by_m + 2. * (x * z + w * y) * bz_m;
+      double hy = 2. * (x * y + w * z) * bx_m + (1. - 2. * (x * x + z * z)) * by_m + 2. * (y * z - w * x) * bz_m;
+      double hz = 2. * (x * z - w * y) * bx_m + 2. * (y * z + w * x) * by_m + (1. - 2. * (x * x + y * y)) * bz_m;
+      double bx = std::sqrt(hx * hx + hy * hy);
+      // Horizontal field predicted back in the body frame, R^T (bx, 0, hz)
+      double px = (1. - 2. * (y * y + z * z)) * bx + 2. * (x * z - w * y) * hz;
+      double py = 2. * (x * y - w * z) * bx + 2. * (y * z + w * x) * hz;
+      double pz = 2. * (x * z + w * y) * bx + (1. - 2. * (x * x + y * y)) * hz;
+      ex += by_m * pz - bz_m * py;
+      ey += bz_m * px - bx_m * pz;
+      ez += bx_m * py - by_m * px;
+    }
+    ix[i] += ki_dt * ex;
+    iy[i] += ki_dt * ey;
+    iz[i] += ki_dt * ez;
+    double wx = gx[i] + kp * ex + ix[i];
+    double wy = gy[i] + kp * ey + iy[i];
+    double wz = gz[i] + kp * ez + iz[i];
+    // q += q (0, w) dt / 2, then normalize
+    double nw = w + half_dt * (-x * wx - y * wy - z * wz);
+    double nx = x + half_dt * (w * wx + y * wz - z * wy);
+    double ny = y + half_dt * (w * wy - x * wz + z * wx);
+    double nz = z + half_dt * (w * wz + x * wy - y * wx);
+    double q_inv = 1. / std::sqrt(nw * nw + nx * nx + ny * ny + nz * nz);
+    q0[i] = nw * q_inv;
+    q1[i] = nx * q_inv;
+    q2[i] = ny * q_inv;
+    q3[i] = nz * q_inv;
+  }
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,151 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "chrono/core/ChMathematics.h"
+#include "chrono_sensor/ChSensorSpectrum.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorFFT::ChSensorFFT(size_t size) : m_size(1) {
+  while (m_size < size)
+    m_size *= 2;
+  m_twiddle.resize(m_size / 2);
+  for (size_t k = 0; k < m_size / 2; ++k) {
+    m_twiddle[k] = std::polar(1., -2. * CH_C_PI * k / m_size);
+  }
+  m_reverse.resize(m_size);
+  size_t bits = 0;
+  while ((size_t(1) << bits) < m_size)
+    ++bits;
+  for (size_t i = 0; i < m_size; ++i) {
+    size_t r = 0;
+    for (size_t b = 0; b < bits; ++b) {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    m_reverse[i] = r;
+  }
+}
+
+void ChSensorFFT::Forward(std::complex<double> *data) const {
+  for (size_t i = 0; i < m_size; ++i) {
+    if (i < m_reverse[i])
+      std::swap(data[i], data[m_reverse[i]]);
+  }
+  for (size_t half = 1; half < m_size; half *= 2) {
+    size_t step = m_size / (2 * half);
+    for (size_t start = 0; start < m_size; start += 2 * half) {
+      for (size_t k = 0; k < half; ++k) {
+        std::complex<double> t = m_twiddle[k * step] * data[start + k + half];
+        data[start + k + half] = data[start + k] - t;
+        data[start + k] += t;
+      }
+    }
+  }
+}
+
+ChSensorWelch::ChSensorWelch(size_t segment, double sample_rate)
+    : m_fft(segment), m_sample_rate(sample_rate), m_segments(0) {
+  size_t n = m_fft.Get_Size();
+  m_window.resize(n);
+  m_window_power = 0.;
+  for (size_t i = 0; i < n; ++i) {
+    // Periodic Hann window, which sums to a constant at half overlap
+    m_window[i] = 0.5 - 0.5 * std::cos(2. * CH_C_PI * i / n);
+    m_window_power += m_window[i] * m_window[i];
+  }
+  m_sum.assign(Get_Bins(), 0.);
+  m_buffer.reserve(n + (BATCH - 1) * Get_Hop());
+}
+
+void ChSensorWelch::Add(const double *samples, size_t count, size_t stride) {
+  // Batches of segments, so the memory is bounded whatever the number of samples added
+  size_t capacity = m_fft.Get_Size() + (BATCH - 1) * Get_Hop();
+  while (count > 0) {
+    size_t take = std::min(count, capacity - m_buffer.size());
+    for (size_t i = 0; i < take; ++i) {
+      m_buffer.push_back(samples[i * stride]);
+    }
+    samples += take * stride;
+    count -= take;
+    Process();
+  }
+}
+
+void ChSensorWelch::Process() {
+  size_t n = m_fft.Get_Size();
+  size_t hop = Get_Hop();
+  if (m_buffer.size() < n)
+    return;
+  long segments = static_cast<long>((m_buffer.size() - n) / hop + 1);
+  size_t bins = Get_Bins();
+#pragma omp parallel
+  {
+    std::vector<std::complex<double>> work(n);
+    std::vector<double> sum(bins, 0.);
+#pragma omp for schedule(static)
+    for (long s = 0; s < segments; ++s) {
+      const double *x = m_buffer.data() + s * hop;
+      for (size_t i = 0; i < n; ++i) {
+        work[i] = x[i] * m_window[i];
+      }
+      m_fft.Forward(work.data());
+      for (size_t k = 0; k < bins; ++k) {
+        sum[k] += std::norm(work[k]);
+      }
+    }
+#pragma omp critical
+    for (size_t k = 0; k < bins; ++k) {
+      m_sum[k] += sum[k];
+    }
+  }
+  m_segments += segments;
+  m_buffer.erase(m_buffer.begin(), m_buffer.begin() + segments * hop);
+}
+
+std::vector<double> ChSensorWelch::Get_PSD() const {
+  std::vector<double> psd(Get_Bins(), 0.);
+  if (m_segments == 0)
+    return psd;
+  size_t n = m_fft.Get_Size();
+  double scale = 1. / (m_sample_rate * m_window_power * m_segments);
+  for (size_t k = 0; k < psd.size(); ++k) {
+    // One sided, except for DC and the Nyquist frequency
+    psd[k] = m_sum[k] * scale * (k == 0 || 2 * k == n ? 1. : 2.);
+  }
+  return psd;
+}
+
+void ChSensorWelch::Reset() {
+  m_buffer.clear();
+  m_sum.assign(Get_Bins(), 0.);
+  m_segments = 0;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,209 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include <algorithm>
+
+#include "chrono_sensor/ChSensorTrace.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+ChSensorTrace::ChSensorTrace(size_t capacity, size_t max_levels)
+    : m_capacity(std::max<size_t>(2, capacity + capacity % 2)), m_max_levels(std::max<size_t>(1, max_levels)),
+      m_count(0) {
+  // Levels are never reallocated, so references to them stay valid while carrying buckets up
+  m_levels.reserve(m_max_levels);
+  Clear();
+}
+
+void ChSensorTrace::Add(double time, double value) {
+  Push(0, {time, time, time, time, value, value, value, 1});
+  ++m_count;
+}
+
+ChSensorTrace::Bucket ChSensorTrace::Merge(const Bucket &a, const Bucket &b) {
+  Bucket merged = a;
+  merged.t_end = b.t_end;
+  if (b.min < a.min) {
+    merged.min = b.min;
+    merged.t_min = b.t_min;
+  }
+  if (b.max > a.max) {
+    merged.max = b.max;
+    merged.t_max = b.t_max;
+  }
+  merged.sum += b.sum;
+  merged.count += b.count;
+  return merged;
+}
+
+void ChSensorTrace::Push(size_t level, const Bucket &bucket) {
+  Level &current = m_levels[level];
+  if (current.buckets.Size() >= m_capacity) {
+    if (level + 1 == m_levels.size()) {
+      if (m_levels.size() < m_max_levels)
+        Add_Level(current);
+      else
+        Compact(current);
+    }
+    // The coarser level keeps the evicted buckets
+    if (level + 1 < m_levels.size()) {
+      current.buckets.Pop();
+      current.evicted = true;
+    }
+  }
+  current.buckets.Push(bucket);
+  if (level + 1 < m_levels.size())
+    Carry(level + 1, bucket);
+}
+
+void ChSensorTrace::Carry(size_t level, const Bucket &bucket) {
+  Level &current = m_levels[level];
+  current.pending = current.pending_count > 0 ? Merge(current.pending, bucket) : bucket;
+  if (++current.pending_count == current.span) {
+    current.pending_count = 0;
+    Push(level, current.pending);
+  }
+}
+
+void ChSensorTrace::Add_Level(const Level &finer) {
+  m_levels.push_back({ChSensorBuffer<Bucket>(m_capacity), Bucket(), 0, 2, false});
+  Level &coarser = m_levels.back();
+  for (size_t i = 0; i + 1 < finer.buckets.Size(); i += 2) {
+    coarser.buckets.Push(Merge(finer.buckets[i], finer.buckets[i + 1]));
+  }
+}
+
+void ChSensorTrace::Compact(Level &level) {
+  // Merge pairs from the back, so the merged buckets end up in the newer half
+  size_t n = level.buckets.Size();
+  for (size_t i = 0; i < n / 2; ++i) {
+    level.buckets[n - 1 - i] = Merge(level.buckets[n - 2 - 2 * i], level.buckets[n - 1 - 2 * i]);
+  }
+  level.buckets.Pop(n / 2);
+  level.span *= 2;
+}
+
+std::vector<ChSensorTrace::Bucket> ChSensorTrace::Get_Buckets(size_t points, double t_start, double t_end) const {
+  std::vector<Bucket> result;
+  if (points == 0 || m_count == 0 || t_end < t_start)
+    return result;
+  // Finest level covering the interval within the number of points
+  size_t level = 0;
+  size_t first = 0;
+  size_t last = 0;
+  Bucket tail{};
+  bool has_tail = false;
+  for (; level < m_levels.size(); ++level) {
+    const auto &buckets = m_levels[level].buckets;
+    size_t lo = 0;
+    size_t hi = buckets.Size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (buckets[mid].t_end < t_start)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    first = lo;
+    hi = buckets.Size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (buckets[mid].t_start <= t_end)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    last = lo;
+    // The newest samples are still pending in this and the finer levels
+    has_tail = false;
+    for (size_t l = level; l > 0; --l) {
+      const Level &pending = m_levels[l];
+      if (pending.pending_count > 0) {
+        tail = has_tail ? Merge(tail, pending.pending) : pending.pending;
+        has_tail = true;
+      }
+    }
+    has_tail = has_tail && tail.t_start <= t_end && tail.t_end >= t_start;
+    bool covered = !m_levels[level].evicted || (!buckets.Empty() && buckets[0].t_start <= t_start);
+    if (level + 1 == m_levels.size() || (covered && last - first + has_tail <= points))
+      break;
+  }
+  // Merge groups of consecutive buckets down to the number of points
+  const auto &buckets = m_levels[level].buckets;
+  size_t n = last - first + has_tail;
+  size_t group = (n + points - 1) / points;
+  result.reserve((n + group - 1) / group);
+  for (size_t i = 0; i < n; ++i) {
+    const Bucket &bucket = first + i < last ? buckets[first + i] : tail;
+    if (i % group == 0)
+      result.push_back(bucket);
+    else
+      result.back() = Merge(result.back(), bucket);
+  }
+  return result;
+}
+
+void ChSensorTrace::Write(std::ostream &out, size_t points, const std::string &delimiter, double t_start,
+                          double t_end) const {
+  for (const auto &bucket : Get_Buckets(points, t_start, t_end)) {
+    out << 0.5 * (bucket.t_start + bucket.t_end) << delimiter << bucket.Get_Mean() << delimiter << bucket.min
+        << delimiter << bucket.max << delimiter << bucket.count << "\n";
+  }
+}
+
+void ChSensorTrace::Fill_Recorder(ChFunction_Recorder &recorder, size_t points, TraceCurve curve, double t_start,
+                                  double t_end) const {
+  for (const auto &bucket : Get_Buckets(points, t_start, t_end)) {
+    switch (curve) {
+      case TRACE_MEAN:recorder.AddPoint(0.5 * (bucket.t_start + bucket.t_end), bucket.Get_Mean());
+        break;
+      case TRACE_MIN:recorder.AddPoint(bucket.t_min, bucket.min);
+        break;
+      case TRACE_MAX:recorder.AddPoint(bucket.t_max, bucket.max);
+        break;
+      case TRACE_ENVELOPE:
+        if (bucket.t_min < bucket.t_max) {
+          recorder.AddPoint(bucket.t_min, bucket.min);
+          recorder.AddPoint(bucket.t_max, bucket.max);
+        } else if (bucket.t_max < bucket.t_min) {
+          recorder.AddPoint(bucket.t_max, bucket.max);
+          recorder.AddPoint(bucket.t_min, bucket.min);
+        } else {
+          recorder.AddPoint(bucket.t_min, bucket.min);
+        }
+        break;
+    }
+  }
+}
+
+void ChSensorTrace::Clear() {
+  m_levels.clear();
+  m_levels.push_back({ChSensorBuffer<Bucket>(m_capacity), Bucket(), 0, 1, false});
+  m_count = 0;
+}
+
+} /// sensor
+} /// vehicle
+} /// chrono
@@ -0,0 +1,87 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#include "chrono_sensor/Magnetometer.h"
+
+namespace chrono {
+namespace vehicle {
+namespace sensor {
+
+Magnetometer::Magnetometer(ChVehicle &vehicle, const double sample_rate, const double delay) : ChSensor<ChVector<>>(
+    vehicle,
+    sample_rate,
+    delay) {
+  m_noise = std::make_shared<ChFunction_SensorNoise<ChVector<>>>();
+  m_digitize = std::make_shared<ChFunction_SensorDigitize<ChVector<>>>();
+  m_transform.push_back(m_noise);
+  m_transform.push_back(m_digitize);
+}
+
+Magnetometer::Magnetometer(const double sample_rate, const double delay) {
+  m_sample_rate = sample_rate;
+  m_delay = delay;
+  m_noise = std::make_shared<ChFunction_SensorNoise<ChVector<>>>();
+  m_digitize = std::make_shared<ChFunction_SensorDigitize<ChVector<>>>();
+  m_transform.push_back(m_noise);
+  m_transform.push_back(m_digitize);
+}
+
+void Magnetometer::Initialize(std::shared_ptr<ChMagneticFieldGrid> field,
+                              const double &bits,
+                              const ChVector<> &range,
+                              const ChVector<> &mean,
+                              const ChVector<> &stddev) {
+  m_field = field;
+  m_digitize->Set_Bits(bits);
+  m_digitize->Set_Range(range);
+  m_noise->Set_Mean(mean);
+  m_noise->Set_Stddev(stddev);
+  ChSensor::Initialize();
+}
+
+void Magnetometer::Synchronize(double time) {
+  if (m_vehicle) {
+    Synchronize(time, m_vehicle->GetVehiclePos(), m_vehicle->GetVehicleRot());
+  } else {
+    ChSensor::Synchronize(time);
+  }
+}
+
+void Magnetometer::Synchronize(double time, const ChVector<> &pos, const ChQuaternion<> &rot) {
+  if (m_field) {
+    // Rotate the world frame field into the sensor frame
+    Set_Input(rot.RotateBack(m_field->Get_Field(pos)));
+  }
+  ChSensor::Synchronize(time);
+}
+
+std::shared_ptr<ChFunction_SensorDigitize<ChVector<>>> Magnetometer::Get_DigitalTransform() {
+  return m_digitize;
+}
+
+std::shared_ptr<ChFunction_SensorNoise<ChVector<>>> Magnetometer::Get_NoiseTransform() {
+  return m_noise;
+}
+} /// sensor
+} /// vehicle
+} /// chrono
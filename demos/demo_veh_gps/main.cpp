@@ -19,6 +19,8 @@
 //
 // =============================================================================
 
+#include <fstream>
+
 #include "chrono/core/ChRealtimeStep.h"
 #include "chrono/utils/ChFilters.h"
 
@@ -33,6 +35,7 @@
 
 #include "chrono_models/vehicle/hmmwv/HMMWV.h"
 #include "chrono_sensor/Accelerometer.h"
+#include "chrono_sensor/ChSensorTrace.h"
 
 #include "chrono_postprocess/ChGnuPlot.h"
 
@@ -116,6 +119,9 @@ const std::string pov_dir = out_dir + "/POVRAY";
 // POV-Ray output
 bool povray_output = false;
 
+// Number of points per plotted curve
+int plot_points = 2000;
+
 // Vehicle state output (forced to true if povray output enabled)
 bool state_output = true;
 int filter_window_size = 20;
@@ -381,12 +387,13 @@ int main(int argc, char *argv[]) {
   // Initialize Sensor
   Accelerometer acc_sensor(my_hmmwv.GetVehicle(), 0.02, 0.03);
   acc_sensor.Initialize(16., ChVector<>(200.), ChVector<>(0.2), ChVector<>(0.2));
-  ChFunction_Recorder x_i;
-  ChFunction_Recorder x_o;
-  ChFunction_Recorder y_i;
-  ChFunction_Recorder y_o;
-  ChFunction_Recorder z_i;
-  ChFunction_Recorder z_o;
+  // Bounded memory traces, for arbitrarily long runs
+  ChSensorTrace x_i;
+  ChSensorTrace x_o;
+  ChSensorTrace y_i;
+  ChSensorTrace y_o;
+  ChSensorTrace z_i;
+  ChSensorTrace z_o;
 
   auto sens_out = std::make_shared<ChVector<>>(0.);
   while (app.GetDevice()->run()) {
@@ -479,32 +486,50 @@ int main(int argc, char *argv[]) {
     my_hmmwv.Advance(step);
     app.Advance(step);
 
-    x_i.AddPoint(time, acc_sensor.Get_Input().x());
-    y_i.AddPoint(time, acc_sensor.Get_Input().y());
-    z_i.AddPoint(time, acc_sensor.Get_Input().z());
-    x_o.AddPoint(time, acc_sensor.Get_Output().x());
-    y_o.AddPoint(time, acc_sensor.Get_Output().y());
-    z_o.AddPoint(time, acc_sensor.Get_Output().z());
+    x_i.Add(time, acc_sensor.Get_Input().x());
+    y_i.Add(time, acc_sensor.Get_Input().y());
+    z_i.Add(time, acc_sensor.Get_Input().z());
+    x_o.Add(time, acc_sensor.Get_Output().x());
+    y_o.Add(time, acc_sensor.Get_Output().y());
+    z_o.Add(time, acc_sensor.Get_Output().z());
     // Increment simulation frame number
     sim_frame++;
 
     app.EndScene();
   }
 
+  // Plot the min/max envelopes of the traces
+  ChFunction_Recorder x_i_plot;
+  ChFunction_Recorder x_o_plot;
+  x_i.Fill_Recorder(x_i_plot, plot_points);
+  x_o.Fill_Recorder(x_o_plot, plot_points);
   postprocess::ChGnuPlot mplot_x("__tmp_gnuplot_x.gpl");
   mplot_x.SetGrid();
-  mplot_x.Plot(x_i, "Input");
-  mplot_x.Plot(x_o, "Output");
+  mplot_x.Plot(x_i_plot, "Input");
+  mplot_x.Plot(x_o_plot, "Output");
 
+  ChFunction_Recorder y_i_plot;
+  ChFunction_Recorder y_o_plot;
+  y_i.Fill_Recorder(y_i_plot, plot_points);
+  y_o.Fill_Recorder(y_o_plot, plot_points);
   postprocess::ChGnuPlot mplot_y("__tmp_gnuplot_y.gpl");
   mplot_y.SetGrid();
-  mplot_y.Plot(y_i, "Input");
-  mplot_y.Plot(y_o, "Output");
+  mplot_y.Plot(y_i_plot, "Input");
+  mplot_y.Plot(y_o_plot, "Output");
 
+  ChFunction_Recorder z_i_plot;
+  ChFunction_Recorder z_o_plot;
+  z_i.Fill_Recorder(z_i_plot, plot_points);
+  z_o.Fill_Recorder(z_o_plot, plot_points);
   postprocess::ChGnuPlot mplot_z("__tmp_gnuplot_z.gpl");
   mplot_z.SetGrid();
-  mplot_z.Plot(z_i, "Input");
-  mplot_z.Plot(z_o, "Output");
+  mplot_z.Plot(z_i_plot, "Input");
+  mplot_z.Plot(z_o_plot, "Output");
+
+  if (state_output) {
+    std::ofstream trace_file(out_dir + "/acc_x_output.dat");
+    x_o.Write(trace_file, plot_points);
+  }
 
   if (state_output)
     csv.write_to_file(out_dir + "/state.out");
@@ -21,6 +21,10 @@
 // SOFTWARE.
 //
 
+#include <array>
+#include <cstdio>
+#include <fstream>
+
 #include <gtest/gtest.h>
 
 #ifndef STAT_TEST // Don't perform statistical tests if boost is not found
@@ -35,6 +39,12 @@
 #include "chrono_sensor/ChFunction_SensorNoise.h"
 #include "chrono_sensor/ChFunction_SensorBias.h"
 #include "chrono_sensor/ChFunction_SensorDigitize.h"
+#include "chrono_sensor/ChFunction_SensorRandomWalk.h"
+#include "chrono_sensor/ChFunction_SensorGaussMarkov.h"
+#include "chrono_sensor/ChFunction_SensorFlicker.h"
+#include "chrono_sensor/ChFunction_SensorFilter.h"
+#include "chrono_sensor/ChFunction_SensorTable.h"
+#include "chrono_sensor/ChFunction_SensorOrientationNoise.h"
 
 using namespace chrono;
 using namespace chrono::vehicle::sensor;
@@ -99,8 +109,205 @@ TEST(Function_Noise, stddev_mean_vector) {
   ASSERT_NEAR(mean(acc_z), mean_val.z(), mean_val.z() / 30.);
   ASSERT_NEAR(sqrt(variance(acc_z)), stddev_val.z(), stddev_val.z() / 30.);
 }
+
+TEST(Function_RandomWalk, increments) {
+  double intensity = 0.3;
+  double dt = 0.01;
+  ChFunction_SensorRandomWalk<> f_walk(intensity);
+
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc;
+
+  f_walk.Update(0.);
+  for (int i = 1; i < 10000; i++) {
+    double prev = f_walk.Get_y(0.);
+    f_walk.Update(i * dt);
+    acc(f_walk.Get_y(0.) - prev);
+  }
+  ASSERT_NEAR(mean(acc), 0., intensity * sqrt(dt) / 10.);
+  ASSERT_NEAR(sqrt(variance(acc)), intensity * sqrt(dt), intensity * sqrt(dt) / 30.);
+}
+
+TEST(Function_RandomWalk, correlated_white_noise) {
+  // The covariance only correlates the white noise, the walk increments keep the intensity
+  ChVector<> intensity(1., 2., 3.);
+  double dt = 0.01;
+  ChFunction_SensorRandomWalk<ChVector<>> f_walk(intensity);
+  ASSERT_TRUE(f_walk.Set_Covariance({1e-4, 5e-5, 0., 5e-5, 1e-4, 0., 0., 0., 1e-4}));
+
+  accumulator_set<double, stats<tag::variance>> acc[3];
+  f_walk.Update(0.);
+  for (int i = 1; i < 20000; i++) {
+    auto prev = f_walk.Get_y(ChVector<>(0.));
+    f_walk.Update(i * dt);
+    auto increment = f_walk.Get_y(ChVector<>(0.)) - prev;
+    for (int c = 0; c < 3; ++c) {
+      acc[c](increment[c]);
+    }
+  }
+  for (int c = 0; c < 3; ++c) {
+    // Walk increment plus the difference of two white noise draws
+    double expected = intensity[c] * intensity[c] * dt + 2e-4;
+    ASSERT_NEAR(variance(acc[c]), expected, 0.05 * expected);
+  }
+}
+
+TEST(Function_GaussMarkov, steady_state) {
+  ChVector<> sigma(0.5, 0.2, 0.);
+  double tau = 0.1;
+  double dt = 0.02;
+  ChFunction_SensorGaussMarkov<ChVector<>> f_gm(sigma, tau);
+
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc_x;
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc_y;
+  accumulator_set<double, stats<tag::mean>> acc_corr;
+
+  f_gm.Set_State(ChVector<>(0.));
+  double prev = 0.;
+  for (int i = 0; i < 50000; i++) {
+    f_gm.Update(i * dt);
+    ChVector<> y = f_gm.Get_y(ChVector<>(1.));
+    acc_x(y.x() - 1.);
+    acc_y(y.y() - 1.);
+    acc_corr((y.x() - 1.) * prev);
+    prev = y.x() - 1.;
+    ASSERT_EQ(y.z(), 1.);
+  }
+  ASSERT_NEAR(sqrt(variance(acc_x)), sigma.x(), sigma.x() / 15.);
+  ASSERT_NEAR(sqrt(variance(acc_y)), sigma.y(), sigma.y() / 15.);
+  // Lag one autocorrelation of the exact discretization
+  ASSERT_NEAR(mean(acc_corr) / variance(acc_x), exp(-dt / tau), 0.03);
+}
+
+TEST(Function_Flicker, variance) {
+  double instability = 0.1;
+  double dt = 0.05;
+  ChFunction_SensorFlicker<> f_flicker(instability, 0.01, 5.);
+  ASSERT_EQ(f_flicker.Get_Poles(), 9);
+
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc;
+  for (int i = 0; i < 200000; i++) {
+    f_flicker.Update(i * dt);
+    if (i > 10000) {
+      acc(f_flicker.Get_y(0.));
+    }
+  }
+  // Every pole contributes B^2 / 2
+  double expected = instability * sqrt(f_flicker.Get_Poles() / 2.);
+  ASSERT_NEAR(sqrt(variance(acc)), expected, expected / 5.);
+}
+
+TEST(Function_Noise, correlated_vector) {
+  ChFunction_SensorNoise<ChVector<>> f_noise(ChVector<>(0.1, 0., -0.1), ChVector<>(0.));
+  ASSERT_TRUE(f_noise.Set_Covariance({0.04, 0.03, 0.,
+                                      0.03, 0.09, -0.02,
+                                      0., -0.02, 0.01}));
+
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc_x;
+  accumulator_set<double, stats<tag::mean, tag::variance>> acc_y;
+  accumulator_set<double, stats<tag::mean>> acc_xy;
+  accumulator_set<double, stats<tag::mean>> acc_yz;
+
+  std::vector<ChVector<>> x(20000, ChVector<>(1.));
+  std::vector<ChVector<>> y(x.size());
+  f_noise.Get_y_Batch(x.data(), y.data(), x.size());
+  for (int i = 0; i < 40000; i++) {
+    ChVector<> noise = (i < 20000 ? y[i] : f_noise.Get_y(ChVector<>(1.))) - ChVector<>(1.) - f_noise.Get_Mean();
+    acc_x(noise.x());
+    acc_y(noise.y());
+    acc_xy(noise.x() * noise.y());
+    acc_yz(noise.y() * noise.z());
+  }
+  ASSERT_NEAR(mean(acc_x), 0., 0.01);
+  ASSERT_NEAR(variance(acc_x), 0.04, 0.04 / 20.);
+  ASSERT_NEAR(variance(acc_y), 0.09, 0.09 / 20.);
+  ASSERT_NEAR(mean(acc_xy), 0.03, 0.03 / 10.);
+  ASSERT_NEAR(mean(acc_yz), -0.02, 0.02 / 10.);
+}
+
+TEST(Function_OrientationNoise, statistics) {
+  ChVector<> mean_val(0.002, 0., -0.001);
+  ChVector<> stddev_val(0.01, 0.005, 0.05);
+  ChFunction_SensorOrientationNoise f_noise(mean_val, stddev_val);
+  ChQuaternion<> x = Q_from_AngAxis(0.7, ChVector<>(1., 2., 3.));
+
+  std::array<accumulator_set<double, stats<tag::mean, tag::variance>>, 3> acc;
+  std::vector<ChQuaternion<>> xs(20000, x);
+  std::vector<ChQuaternion<>> ys(xs.size());
+  f_noise.Get_y_Batch(xs.data(), ys.data(), xs.size());
+  for (int i = 0; i < 40000; i++) {
+    ChQuaternion<> y = i < 20000 ? ys[i] : f_noise.Get_y(x);
+    ASSERT_NEAR(y.Length(), 1., 1e-12);
+    // The body frame rotation vector of the noise
+    ChVector<> theta = ChFunction_SensorOrientationNoise::Log_Map(x.GetConjugate() * y);
+    for (int c = 0; c < 3; ++c) {
+      acc[c](theta[c]);
+    }
+  }
+  for (int c = 0; c < 3; ++c) {
+    ASSERT_NEAR(mean(acc[c]), mean_val[c], stddev_val[c] / 30.);
+    ASSERT_NEAR(sqrt(variance(acc[c])), stddev_val[c], stddev_val[c] / 30.);
+  }
+}
 #endif
 
+TEST(Function_Noise, covariance) {
+  ChFunction_SensorNoise<ChVector<>> f_noise(ChVector<>(0.), ChVector<>(0.1, 0.2, 0.3));
+  ASSERT_FALSE(f_noise.Is_Correlated());
+  ASSERT_NEAR(f_noise.Get_Covariance()[4], 0.04, 1e-15);
+
+  ChFunction_SensorNoise<ChVector<>>::Covariance covariance{4., 2., 0., 2., 5., 1., 0., 1., 3.};
+  ASSERT_TRUE(f_noise.Set_Covariance(covariance));
+  ASSERT_TRUE(f_noise.Is_Correlated());
+  auto factored = f_noise.Get_Covariance();
+  for (size_t i = 0; i < covariance.size(); ++i) {
+    ASSERT_NEAR(factored[i], covariance[i], 1e-12);
+  }
+  ASSERT_NEAR(f_noise.Get_Stddev().y(), sqrt(5.), 1e-12);
+
+  // Not positive definite and not symmetric
+  ASSERT_FALSE(f_noise.Set_Covariance({1., 2., 0., 2., 1., 0., 0., 0., 1.}));
+  ASSERT_FALSE(f_noise.Set_Covariance({1., 0.5, 0., 0., 1., 0., 0., 0., 1.}));
+  ASSERT_NEAR(f_noise.Get_Covariance()[1], 2., 1e-12);
+
+  f_noise.Set_Stddev(ChVector<>(1.));
+  ASSERT_FALSE(f_noise.Is_Correlated());
+}
+
+TEST(Function_Noise, quaternion_covariance) {
+  ChFunction_SensorNoise<ChQuaternion<>> f_noise(ChQuaternion<>(1., 0., 0., 0.), ChQuaternion<>(0.));
+  ChFunction_SensorNoise<ChQuaternion<>>::Covariance covariance{0.04, 0.01, 0., 0.,
+                                                               0.01, 0.02, -0.01, 0.,
+                                                               0., -0.01, 0.03, 0.005,
+                                                               0., 0., 0.005, 0.01};
+  ASSERT_TRUE(f_noise.Set_Covariance(covariance));
+  ASSERT_TRUE(f_noise.Is_Correlated());
+
+  // Perturbations of the identity are the noise quaternions themselves, both per sample and batched
+  const size_t n = 100000;
+  std::vector<ChQuaternion<>> x(n, ChQuaternion<>(1., 0., 0., 0.));
+  std::vector<ChQuaternion<>> y(2 * n);
+  for (size_t i = 0; i < n; ++i) {
+    y[i] = f_noise.Get_y(x[i]);
+  }
+  f_noise.Get_y_Batch(x.data(), y.data() + n, n);
+  for (size_t half = 0; half < 2; ++half) {
+    std::array<double, 4> mean{};
+    std::array<double, 16> sample{};
+    for (size_t i = half * n; i < (half + 1) * n; ++i) {
+      for (size_t r = 0; r < 4; ++r) {
+        mean[r] += y[i][r] / n;
+        for (size_t c = 0; c < 4; ++c) {
+          sample[r * 4 + c] += (y[i][r] - (r == 0)) * (y[i][c] - (c == 0)) / n;
+        }
+      }
+    }
+    ASSERT_NEAR(mean[0], 1., 5e-3);
+    for (size_t i = 0; i < covariance.size(); ++i) {
+      ASSERT_NEAR(sample[i], covariance[i], 2e-3);
+    }
+  }
+}
+
 TEST(Function_Noise, clone) {
   double mean_val = 0.5;
   double stddev_val = 0.2;
@@ -177,3 +384,169 @@ TEST(Function_Digitize, quaternion) {
   auto r = ChQuaternion<>(0.49950151852068797, ChVector<>(0.50016605009254234));
   ASSERT_TRUE(t.Equals(r));
 }
+
+TEST(Function_Filter, dc_gain) {
+  ChFunction_SensorFilter<ChVector<>> f_filter;
+  f_filter.Set_Decimation(1e-3, 1e-2, 31);
+  ChVector<> x(1., -2., 3.);
+  for (int i = 0; i < 40; ++i) {
+    f_filter.Push(x);
+  }
+  ASSERT_TRUE(f_filter.Get_y(ChVector<>(0.)).Equals(x, 1e-12));
+}
+
+TEST(Function_Filter, anti_aliasing) {
+  // 1 kHz simulation step, 100 Hz sensor; a 400 Hz vibration would alias to 0 Hz without the filter
+  double step = 1e-3;
+  ChFunction_SensorFilter<> f_filter;
+  f_filter.Set_Decimation(step, 1e-2, 63);
+  double max_out = 0.;
+  for (int i = 0; i < 2000; ++i) {
+    f_filter.Push(1. + sin(2. * CH_C_PI * 400. * i * step));
+    if (i > 100 && i % 10 == 0) {
+      max_out = std::max(max_out, std::abs(f_filter.Get_y(0.) - 1.));
+    }
+  }
+  ASSERT_LT(max_out, 0.01);
+}
+
+TEST(Function_Derivatives, closed_form) {
+  ChVector<> x(1.3, -2.1, 0.4);
+  ChFunction_SensorBias<ChVector<>> f_bias(ChVector<>(5., 4., 3.));
+  ChFunction_SensorNoise<ChVector<>> f_noise(ChVector<>(0.5), ChVector<>(0.2));
+  ChFunction_SensorDigitize<ChVector<>> f_dig(12., ChVector<>(50.));
+  ASSERT_EQ(f_bias.Get_y_dx(x), ChVector<>(1.));
+  ASSERT_EQ(f_bias.Get_y_dxdx(x), ChVector<>(0.));
+  ASSERT_EQ(f_noise.Get_y_dx(x), ChVector<>(1.));
+  ASSERT_EQ(f_noise.Get_y_dxdx(x), ChVector<>(0.));
+  ASSERT_EQ(f_dig.Get_y_dx(x), ChVector<>(0.));
+  ASSERT_EQ(f_dig.Get_y_dN(x, 2), ChVector<>(0.));
+
+  std::vector<ChVector<>> xs(64, x);
+  std::vector<ChVector<>> dydx(64, ChVector<>(-1.));
+  f_noise.Get_y_dx_Batch(xs.data(), dydx.data(), xs.size());
+  for (auto &d : dydx) {
+    ASSERT_EQ(d, ChVector<>(1.));
+  }
+  f_dig.Get_y_dxdx_Batch(xs.data(), dydx.data(), xs.size());
+  for (auto &d : dydx) {
+    ASSERT_EQ(d, ChVector<>(0.));
+  }
+}
+
+TEST(Function_Derivatives, numerical_agreement) {
+  // Away from the digitization steps the closed forms match the numerical derivative of the base class
+  double x = 3.45;
+  ChFunction_SensorBias<> f_bias(2.5);
+  ChFunction_SensorDigitize<> f_dig(4., 50.);
+  ASSERT_NEAR(f_bias.Get_y_dx(x), f_bias.ChFunction_Sensor<double>::Get_y_dx(x), 1e-6);
+  ASSERT_EQ(f_dig.Get_y_dx(x), f_dig.ChFunction_Sensor<double>::Get_y_dx(x));
+}
+
+TEST(Function_Table, interpolation) {
+  // Quadratic scale factor nonlinearity y = x + 0.01 x^2 tabulated on [-10, 10]
+  std::vector<double> values;
+  for (int i = 0; i <= 200; ++i) {
+    double x = -10. + 0.1 * i;
+    values.push_back(x + 0.01 * x * x);
+  }
+  ChFunction_SensorTable<> f_table(-10., 10., values);
+  ASSERT_NEAR(f_table.Get_y(2.), 2.04, 1e-9);
+  ASSERT_NEAR(f_table.Get_y(2.05), 2.05 + 0.01 * 2.05 * 2.05, 3e-5);
+  ASSERT_NEAR(f_table.Get_y(-20.), -9., 1e-12);
+  ASSERT_NEAR(f_table.Get_y(20.), 11., 1e-12);
+  ASSERT_TRUE(std::isnan(f_table.Get_y(std::nan(""))));
+
+  std::vector<double> xs, ys(1000);
+  for (int i = 0; i < 1000; ++i) {
+    xs.push_back(-12. + 0.024 * i);
+  }
+  xs[500] = std::nan("");
+  f_table.Get_y_Batch(xs.data(), ys.data(), xs.size());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    if (i == 500) {
+      ASSERT_TRUE(std::isnan(ys[i]));
+    } else {
+      ASSERT_EQ(ys[i], f_table.Get_y(xs[i]));
+    }
+  }
+
+  ChFunction_Ramp ramp(1., 2.);
+  f_table.Set_Table(ramp, 0., 1., 11);
+  ASSERT_NEAR(f_table.Get_y(0.25), 1.5, 1e-12);
+}
+
+TEST(Function_Table, misalignment) {
+  ChFunction_SensorTable<ChVector<>> f_table;
+  f_table.Set_Table(0., 1., std::vector<double>{0., 2.}, 0);
+  ChMatrix33<> misalignment(1.);
+  misalignment(1, 0) = 0.01;
+  f_table.Set_Misalignment(misalignment);
+  ChVector<> y = f_table.Get_y(ChVector<>(0.5, 1., 3.));
+  ASSERT_NEAR(y.x(), 1., 1e-12);
+  ASSERT_NEAR(y.y(), 1.01, 1e-12);
+  ASSERT_NEAR(y.z(), 3., 1e-12);
+
+  std::string filename = "sensor_table_test.csv";
+  {
+    std::ofstream out(filename);
+    out << "# x, y_x, y_y, y_z\n0, 0, 0, 0\n1, 1, 3, -1\n2, 2, 6, -2\n";
+  }
+  ASSERT_TRUE(f_table.Load(filename));
+  f_table.Clear_Misalignment();
+  y = f_table.Get_y(ChVector<>(0.5, 1.5, 1.));
+  ASSERT_NEAR(y.x(), 0.5, 1e-12);
+  ASSERT_NEAR(y.y(), 4.5, 1e-12);
+  ASSERT_NEAR(y.z(), -1., 1e-12);
+  std::remove(filename.c_str());
+}
+
+TEST(Function_OrientationNoise, exponential_map) {
+  // The series and trigonometric branches agree on both sides of the switch
+  for (double angle : {1e-9, 1e-3, 0.0199, 0.0201, 0.5, 3.}) {
+    ChVector<> theta = ChVector<>(0.6, -0.8, 0.).GetNormalized() * angle;
+    ChQuaternion<> q = ChFunction_SensorOrientationNoise::Exp_Map(theta);
+    ChQuaternion<> expected = Q_from_AngAxis(angle, theta);
+    ASSERT_TRUE(q.Equals(expected, 1e-14));
+    ChVector<> log = ChFunction_SensorOrientationNoise::Log_Map(q);
+    ASSERT_NEAR((log - theta).Length(), 0., 1e-12);
+  }
+
+  ChFunction_SensorOrientationNoise f_noise;
+  ChQuaternion<> x = Q_from_AngAxis(0.3, ChVector<>(0., 0., 1.));
+  ASSERT_TRUE(f_noise.Get_y(x).Equals(x, 1e-15));
+}
+
+TEST(Function_Snapshot, stateful_resume) {
+  ChFunction_SensorFlicker<ChVector<>> f_flicker(ChVector<>(0.1), 0.01, 5.);
+  ChFunction_SensorRandomWalk<> f_walk(0.3);
+  ChFunction_SensorOrientationNoise f_orientation(ChVector<>(0.), ChVector<>(0.01));
+  for (int i = 0; i < 100; ++i) {
+    f_flicker.Update(i * 0.01);
+    f_walk.Update(i * 0.01);
+  }
+  ChSensorSnapshot snapshot;
+  f_flicker.SnapshotOut(snapshot);
+  f_walk.SnapshotOut(snapshot);
+  f_orientation.SnapshotOut(snapshot);
+
+  ChFunction_SensorFlicker<ChVector<>> r_flicker;
+  ChFunction_SensorRandomWalk<> r_walk;
+  ChFunction_SensorOrientationNoise r_orientation;
+  ASSERT_TRUE(r_flicker.SnapshotIn(snapshot));
+  ASSERT_TRUE(r_walk.SnapshotIn(snapshot));
+  ASSERT_TRUE(r_orientation.SnapshotIn(snapshot));
+  ASSERT_FALSE(r_walk.SnapshotIn(snapshot));
+  ASSERT_EQ(r_flicker.Get_Poles(), f_flicker.Get_Poles());
+
+  ChQuaternion<> q(1., 0., 0., 0.);
+  for (int i = 100; i < 200; ++i) {
+    f_flicker.Update(i * 0.01);
+    r_flicker.Update(i * 0.01);
+    f_walk.Update(i * 0.01);
+    r_walk.Update(i * 0.01);
+    ASSERT_EQ(r_flicker.Get_y(ChVector<>(1.)), f_flicker.Get_y(ChVector<>(1.)));
+    ASSERT_EQ(r_walk.Get_y(1.), f_walk.Get_y(1.));
+    ASSERT_EQ(r_orientation.Get_y(q), f_orientation.Get_y(q));
+  }
+}
@@ -2,9 +2,1812 @@
 // Created by Konstantin Gredeskoul on 5/16/17.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
 #include <gtest/gtest.h>
 
+#include "chrono_sensor/ChMagneticFieldGrid.h"
+#include "chrono_sensor/Magnetometer.h"
+#include "chrono_sensor/ChSensor.h"
+#include "chrono_sensor/ChSensorAllan.h"
+#include "chrono_sensor/ChSensorChannel.h"
+#include "chrono_sensor/ChSensorCsvWriter.h"
+#include "chrono_sensor/ChSensorDropout.h"
+#include "chrono_sensor/ChSensorInsEstimator.h"
+#include "chrono_sensor/ChSensorLatency.h"
+#include "chrono_sensor/ChSensorLogReader.h"
+#include "chrono_sensor/ChSensorMahony.h"
+#include "chrono_sensor/ChSensorShmPublisher.h"
+#include "chrono_sensor/ChSensorSpectrum.h"
+#include "chrono_sensor/ChSensorStatistics.h"
+#include "chrono_sensor/ChSensorTrace.h"
+#include "chrono_sensor/ChFunction_SensorBias.h"
+#include "chrono_sensor/ChFunction_SensorDigitize.h"
+#include "chrono_sensor/ChFunction_SensorFilter.h"
+#include "chrono_sensor/ChFunction_SensorGaussMarkov.h"
+#include "chrono_sensor/ChFunction_SensorNoise.h"
+#include "chrono_sensor/ChFunction_SensorOrientationNoise.h"
+#include "chrono_sensor/ChFunction_SensorTable.h"
+
+// Count the heap allocations of the test binary. Every replaceable form is replaced, so all of them are counted and
+// each allocation is released by the matching function; they are kept out of line, so the compiler doesn't pair
+// an inlined malloc() with the operator delete of the caller.
+static std::atomic<size_t> allocations(0);
+
+[[gnu::noinline]] static void *Counted_Alloc(std::size_t size, std::size_t alignment) {
+  ++allocations;
+  size = size == 0 ? 1 : size;
+  if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    return std::malloc(size);
+  return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] static void *Counted_New(std::size_t size, std::size_t alignment) {
+  if (void *ptr = Counted_Alloc(size, alignment))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void *operator new(std::size_t size) {
+  return Counted_New(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+[[gnu::noinline]] void *operator new[](std::size_t size) {
+  return Counted_New(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+[[gnu::noinline]] void *operator new(std::size_t size, std::align_val_t alignment) {
+  return Counted_New(size, static_cast<std::size_t>(alignment));
+}
+
+[[gnu::noinline]] void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return Counted_New(size, static_cast<std::size_t>(alignment));
+}
+
+[[gnu::noinline]] void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return Counted_Alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+[[gnu::noinline]] void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return Counted_Alloc(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+[[gnu::noinline]] void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return Counted_Alloc(size, static_cast<std::size_t>(alignment));
+}
+
+[[gnu::noinline]] void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return Counted_Alloc(size, static_cast<std::size_t>(alignment));
+}
+
+[[gnu::noinline]] void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
+[[gnu::noinline]] void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  std::free(ptr);
+}
+
 TEST(sensor, test1) {
   auto test = 1;
   ASSERT_EQ(1, 1);
-}
\ No newline at end of file
+}
+TEST(MagneticField, dipole) {
+  // At the equator and prime meridian only the degree 1 terms contribute to the local field
+  chrono::vehicle::sensor::ChMagneticFieldSH model;
+  auto field = model.Get_Field(chrono::ChVector<>(0.));
+  ASSERT_NEAR(field.x(), -4652.5e-9, 1e-12);
+  ASSERT_NEAR(field.y(), 29404.8e-9, 1e-12);
+  ASSERT_NEAR(field.z(), -2. * 1450.9e-9, 1e-12);
+}
+
+TEST(MagneticField, grid_interpolation) {
+  chrono::vehicle::sensor::ChMagneticFieldSH model;
+  model.Set_Origin(52., 5., 0.);
+  chrono::vehicle::sensor::ChMagneticFieldGrid grid;
+  chrono::ChVector<> min(-150., -150., -5.);
+  chrono::ChVector<> max(150., 150., 20.);
+  grid.Initialize(model, min, max, 10.);
+  for (int i = 0; i < 100; ++i) {
+    chrono::ChVector<> pos(-149. + 2.9 * i, 120. - 2.3 * i, -5. + 0.25 * i);
+    auto expected = model.Get_Field(pos);
+    auto actual = grid.Get_Field(pos);
+    for (int d = 0; d < 3; ++d) {
+      ASSERT_NEAR(actual[d], expected[d], 1e-12);
+    }
+  }
+}
+
+TEST(MagneticField, grid_cache) {
+  chrono::vehicle::sensor::ChMagneticFieldSH model;
+  model.Set_Origin(52., 5., 0.);
+  chrono::vehicle::sensor::ChMagneticFieldGrid grid;
+  std::string filename("magnetic_field_grid.dat");
+  std::remove(filename.c_str());
+  grid.Initialize(model, chrono::ChVector<>(-10.), chrono::ChVector<>(10.), 5., filename);
+
+  chrono::vehicle::sensor::ChMagneticFieldGrid cached;
+  ASSERT_TRUE(cached.Load(filename, model.Get_Hash()));
+  ASSERT_EQ(cached.Get_Dimensions(), grid.Get_Dimensions());
+  chrono::ChVector<> pos(1.5, -3.2, 7.1);
+  ASSERT_EQ(cached.Get_Field(pos), grid.Get_Field(pos));
+
+  model.Set_Origin(10., 5., 0.);
+  ASSERT_FALSE(cached.Load(filename, model.Get_Hash()));
+  std::remove(filename.c_str());
+}
+
+TEST(MagneticField, grid_invalid) {
+  chrono::vehicle::sensor::ChMagneticFieldSH model;
+  chrono::vehicle::sensor::ChMagneticFieldGrid grid;
+  ASSERT_FALSE(grid.Initialize(model, chrono::ChVector<>(-10.), chrono::ChVector<>(10.), 0.));
+  ASSERT_FALSE(grid.Initialize(model, chrono::ChVector<>(-10.), chrono::ChVector<>(10.), -1.));
+  ASSERT_FALSE(grid.Initialize(model, chrono::ChVector<>(-10.), chrono::ChVector<>(10.), std::nan("")));
+  ASSERT_FALSE(grid.Initialize(model, chrono::ChVector<>(10.), chrono::ChVector<>(-10.), 5.));
+  ASSERT_EQ(grid.Get_Dimensions(), (std::array<int, 3>{1, 1, 1}));
+  ASSERT_TRUE(grid.Initialize(model, chrono::ChVector<>(-10.), chrono::ChVector<>(10.), 5.));
+}
+
+TEST(MagneticField, magnetometer) {
+  using namespace chrono::vehicle::sensor;
+  ChMagneticFieldSH model;
+  model.Set_Origin(52., 5., 0.);
+  auto grid = std::make_shared<ChMagneticFieldGrid>();
+  ASSERT_TRUE(grid->Initialize(model, chrono::ChVector<>(-50.), chrono::ChVector<>(50.), 10.));
+
+  // 100 Hz magnetometer with a 20 ms delay, without noise or digitization
+  Magnetometer magnetometer(1e-2, 2e-2);
+  magnetometer.Initialize(grid, 0., chrono::ChVector<>(0.), chrono::ChVector<>(0.), chrono::ChVector<>(0.));
+  auto rot = chrono::Q_from_AngAxis(90 * CH_C_DEG_TO_RAD, chrono::ChVector<>(0., 0., 1.));
+  double step = 1e-2;
+  std::vector<chrono::ChVector<>> expected;
+  size_t count = 0;
+  for (int i = 0; i < 20; ++i) {
+    double time = i * step;
+    chrono::ChVector<> pos(-40. + 4. * i, 3. * i, 0.5 * i);
+    expected.push_back(rot.RotateBack(grid->Get_Field(pos)));
+    magnetometer.Synchronize(time, pos, rot);
+    magnetometer.Advance(step);
+    // The field is measured in the sensor frame and released after the delay
+    for (auto &sample : magnetometer.Get_Released()) {
+      ASSERT_NEAR(sample.release, sample.time + 2e-2, 1e-12);
+      auto &value = expected[static_cast<size_t>(std::lround(sample.time / step))];
+      for (int d = 0; d < 3; ++d) {
+        ASSERT_NEAR(sample.value[d], value[d], 1e-15);
+      }
+      ++count;
+    }
+  }
+  ASSERT_GE(count, 17);
+  // A quarter turn about z maps the world y axis onto the sensor -x axis
+  auto field = grid->Get_Field(chrono::ChVector<>(0.));
+  magnetometer.Synchronize(20 * step, chrono::ChVector<>(0.), rot);
+  ASSERT_NEAR(magnetometer.Get_Input().x(), field.y(), 1e-15);
+  ASSERT_NEAR(magnetometer.Get_Input().y(), -field.x(), 1e-15);
+}
+
+TEST(Sensor, oversampling_linear) {
+  // 1 kHz sensor on a 2 ms simulation step
+  chrono::vehicle::sensor::ChSensor<double> sensor;
+  sensor.Set_SampleRate(1e-3);
+  sensor.Set_SampleMode(chrono::vehicle::sensor::SAMPLE_LINEAR);
+  double step = 2e-3;
+  size_t count = 0;
+  for (int i = 0; i < 100; ++i) {
+    double time = i * step;
+    sensor.Set_Input(3. * time + 1.);
+    sensor.Synchronize(time);
+    sensor.Advance(step);
+    auto &released = sensor.Get_Released();
+    ASSERT_EQ(released.size(), i == 0 ? 1 : 2);
+    for (auto &sample : released) {
+      ASSERT_NEAR(sample.time, count * 1e-3, 1e-12);
+      ASSERT_NEAR(sample.value, 3. * sample.time + 1., 1e-12);
+      ++count;
+    }
+    ASSERT_EQ(sensor.Get_Output(), released.back().value);
+  }
+}
+
+TEST(Sensor, oversampling_hermite) {
+  chrono::vehicle::sensor::ChSensor<chrono::ChVector<>> sensor;
+  sensor.Set_SampleRate(1e-3);
+  sensor.Set_Delay(4e-3);
+  sensor.Set_SampleMode(chrono::vehicle::sensor::SAMPLE_HERMITE);
+  double step = 5e-3;
+  double max_error = 0.;
+  for (int i = 0; i < 200; ++i) {
+    double time = i * step;
+    sensor.Set_Input(chrono::ChVector<>(sin(time), cos(time), time));
+    sensor.Synchronize(time);
+    sensor.Advance(step);
+    for (auto &sample : sensor.Get_Released()) {
+      // Released once the delay has passed
+      ASSERT_LE(sample.time + 4e-3, time + 1e-12);
+      ASSERT_GT(sample.time + 4e-3, time - step);
+      if (sample.time > 2. * step) {
+        max_error = std::max(max_error, std::abs(sample.value.x() - sin(sample.time)));
+        max_error = std::max(max_error, std::abs(sample.value.z() - sample.time));
+      }
+    }
+  }
+  ASSERT_LT(max_error, 1e-5);
+}
+
+TEST(Sensor, oversampling_transforms) {
+  chrono::vehicle::sensor::ChSensor<double> sensor;
+  sensor.Set_SampleRate(5e-4);
+  sensor.Set_SampleMode(chrono::vehicle::sensor::SAMPLE_LINEAR);
+  sensor.Add_Transform(std::make_shared<chrono::vehicle::sensor::ChFunction_SensorBias<>>(2.));
+  sensor.Set_Input(1.);
+  sensor.Synchronize(0.);
+  sensor.Advance(2e-3);
+  sensor.Synchronize(2e-3);
+  sensor.Advance(2e-3);
+  ASSERT_EQ(sensor.Get_Released().size(), 4);
+  for (auto &sample : sensor.Get_Released()) {
+    ASSERT_EQ(sample.value, 3.);
+  }
+}
+
+TEST(Sensor, filter_after_bias) {
+  using namespace chrono::vehicle::sensor;
+  // 100 Hz sensor on a 1 ms step, the anti-aliasing filter placed after a bias
+  ChSensor<double> sensor;
+  sensor.Set_SampleRate(1e-2);
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<>>(2.));
+  auto filter = std::make_shared<ChFunction_SensorFilter<>>();
+  filter->Set_Decimation(1e-3, 1e-2, 15);
+  sensor.Add_Transform(filter);
+  sensor.Set_Input(1.);
+  for (int i = 0; i < 50; ++i) {
+    sensor.Synchronize(i * 1e-3);
+    sensor.Advance(1e-3);
+  }
+  ASSERT_NEAR(sensor.Get_Output(), 3., 1e-12);
+
+  // Oversampled, the filter output is interpolated between the steps like the input
+  ChSensor<double> oversampled;
+  oversampled.Set_SampleRate(2.5e-4);
+  oversampled.Set_SampleMode(SAMPLE_LINEAR);
+  oversampled.Add_Transform(std::make_shared<ChFunction_SensorBias<>>(2.));
+  oversampled.Add_Transform(std::make_shared<ChFunction_SensorFilter<>>(std::vector<double>{0.5, 0.5}));
+  for (int i = 0; i < 10; ++i) {
+    double time = i * 1e-3;
+    oversampled.Set_Input(time);
+    oversampled.Synchronize(time);
+    oversampled.Advance(1e-3);
+    if (i < 2)
+      continue;
+    ASSERT_EQ(oversampled.Get_Released().size(), 4);
+    for (auto &sample : oversampled.Get_Released()) {
+      // Two tap average of a ramp, delayed by half a step
+      ASSERT_NEAR(sample.value, sample.time - 0.5e-3 + 2., 1e-12);
+    }
+  }
+}
+
+TEST(Sensor, filter_evaluations) {
+  using namespace chrono::vehicle::sensor;
+  // Counts the convolutions of a decimating filter
+  class CountingFilter : public ChFunction_SensorFilter<double> {
+   public:
+    double Get_y_Delayed(const double &x, const size_t steps) const override {
+      ++evaluations;
+      return ChFunction_SensorFilter<double>::Get_y_Delayed(x, steps);
+    }
+    mutable size_t evaluations = 0;
+  };
+  for (SampleMode mode : {SAMPLE_STEP, SAMPLE_LINEAR, SAMPLE_HERMITE}) {
+    // 100 Hz sensor on a 1 ms step, the filter output is only evaluated for the samples
+    ChSensor<double> sensor;
+    sensor.Set_SampleRate(1e-2);
+    sensor.Set_SampleMode(mode);
+    auto filter = std::make_shared<CountingFilter>();
+    filter->Set_Decimation(1e-3, 1e-2, 31);
+    sensor.Add_Transform(filter);
+    size_t samples = 0;
+    for (int i = 0; i < 1000; ++i) {
+      double time = i * 1e-3;
+      sensor.Set_Input(std::sin(time));
+      sensor.Synchronize(time);
+      sensor.Advance(1e-3);
+      samples += sensor.Get_Released().size();
+    }
+    ASSERT_GE(samples, 99);
+    // The interpolation also reads the outputs of up to two previous steps
+    ASSERT_GE(filter->evaluations, samples);
+    ASSERT_LE(filter->evaluations, 3 * samples);
+  }
+}
+
+TEST(Sensor, step_timing) {
+  // The 3 ms step doesn't divide the 20 ms sample period
+  chrono::vehicle::sensor::ChSensor<double> sensor;
+  sensor.Set_SampleRate(0.02);
+  sensor.Set_Delay(0.05);
+  double step = 3e-3;
+  size_t count = 0;
+  for (int i = 0; i < 3334; ++i) {
+    double time = i * step;
+    sensor.Set_Input(time);
+    sensor.Synchronize(time);
+    sensor.Advance(step);
+    for (auto &sample : sensor.Get_Released()) {
+      ++count;
+      // Sampled at the first step after the nominal instant, released at the first step after the delay
+      ASSERT_GE(sample.time, count * 0.02 - 1e-9);
+      ASSERT_LT(sample.time, count * 0.02 + step);
+      ASSERT_EQ(sample.release, sample.time + 0.05);
+      ASSERT_GE(time, sample.release - 1e-12);
+      ASSERT_LT(time, sample.release + step);
+    }
+  }
+  // No drift of the sample schedule over 10 s
+  ASSERT_EQ(count, 497);
+}
+
+TEST(Sensor, exact_timing) {
+  chrono::vehicle::sensor::ChSensor<double> sensor;
+  sensor.Set_SampleRate(0.02);
+  sensor.Set_Delay(0.05);
+  sensor.Set_SampleMode(chrono::vehicle::sensor::SAMPLE_LINEAR);
+  double step = 7e-3;
+  size_t count = 0;
+  for (int i = 0; i < 1000; ++i) {
+    double time = i * step;
+    sensor.Set_Input(2. * time);
+    sensor.Synchronize(time);
+    sensor.Advance(step);
+    for (auto &sample : sensor.Get_Released()) {
+      ASSERT_NEAR(sample.time, count * 0.02, 1e-12);
+      ASSERT_NEAR(sample.release, count * 0.02 + 0.05, 1e-12);
+      ASSERT_NEAR(sample.value, 2. * sample.time, 1e-12);
+      ++count;
+    }
+    if (!sensor.Get_Released().empty()) {
+      ASSERT_EQ(sensor.Get_OutputTime(), sensor.Get_Released().back().release);
+    }
+  }
+}
+
+TEST(Sensor, latency) {
+  using namespace chrono::vehicle::sensor;
+  for (auto policy : {DELIVER_IN_ORDER, DELIVER_REORDER}) {
+    ChSensor<double> sensor;
+    sensor.Set_SampleRate(1e-3);
+    sensor.Set_Delay(2e-3);
+    sensor.Set_SampleMode(SAMPLE_LINEAR);
+    auto latency = std::make_shared<ChSensorLatency>(LATENCY_EXPONENTIAL, 5e-3);
+    latency->Set_Seed(42);
+    sensor.Set_Latency(latency);
+    sensor.Set_DeliveryPolicy(policy);
+
+    std::vector<double> times;
+    size_t overtaken = 0;
+    double prev_sample = -1.;
+    for (int i = 0; i <= 2000; ++i) {
+      double time = i * 1e-3;
+      sensor.Set_Input(time);
+      sensor.Synchronize(time);
+      sensor.Advance(1e-3);
+      double prev_release = -1.;
+      for (auto &sample : sensor.Get_Released()) {
+        ASSERT_GE(sample.release, sample.time + 2e-3 - 1e-12);
+        ASSERT_LE(sample.release, time + 1e-12);
+        ASSERT_GE(sample.release, prev_release);
+        ASSERT_NEAR(sample.value, sample.time, 1e-12);
+        if (sample.time < prev_sample) {
+          ++overtaken;
+        }
+        prev_sample = sample.time;
+        prev_release = sample.release;
+        times.push_back(sample.time);
+      }
+    }
+
+    // Samples are delivered at most once, in order unless reordering is allowed. Only the last few samples may
+    // still be pending at the end.
+    std::sort(times.begin(), times.end());
+    ASSERT_GT(times.size(), 1900);
+    for (size_t k = 0; k < 1900; ++k) {
+      ASSERT_NEAR(times[k], k * 1e-3, 1e-12);
+    }
+    ASSERT_TRUE(std::adjacent_find(times.begin(), times.end()) == times.end());
+    if (policy == DELIVER_IN_ORDER) {
+      ASSERT_EQ(overtaken, 0);
+    } else {
+      ASSERT_GT(overtaken, 100);
+    }
+  }
+}
+
+class CountingCallback : public chrono::vehicle::sensor::ChSensor<double>::OutputCallback {
+ public:
+  void OnOutput(const chrono::vehicle::sensor::ChSensorSample<double> &sample) override {
+    ASSERT_GT(sample.time, last_time);
+    last_time = sample.time;
+    ++count;
+  }
+
+  double last_time = -1.;
+  size_t count = 0;
+};
+
+TEST(Sensor, output_callback_dropout) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<double> sensor;
+  sensor.Set_SampleRate(1e-2);
+  sensor.Set_Delay(2e-2);
+  auto dropout = std::make_shared<ChSensorDropout>(0.02, 0.3, 0.01, 0.8);
+  dropout->Set_Seed(7);
+  sensor.Set_Dropout(dropout);
+  auto callback = std::make_shared<CountingCallback>();
+  sensor.Add_OutputCallback(callback);
+
+  size_t released = 0;
+  for (int i = 0; i <= 100000; ++i) {
+    double time = i * 1e-3;
+    sensor.Set_Input(time);
+    sensor.Synchronize(time);
+    sensor.Advance(1e-3);
+    released += sensor.Get_Released().size();
+    ASSERT_EQ(callback->count, released);
+    if (!sensor.Get_Released().empty()) {
+      ASSERT_EQ(callback->last_time, sensor.Get_Released().back().time);
+    }
+  }
+
+  // Every sample is either delivered through the callback or dropped, at the stationary loss rate
+  size_t total = callback->count + sensor.Get_DroppedCount();
+  ASSERT_NEAR(total, 10000, 3);
+  ASSERT_NEAR(static_cast<double>(sensor.Get_DroppedCount()) / total, dropout->Get_LossRate(),
+              dropout->Get_LossRate() / 5.);
+
+  sensor.Remove_OutputCallback(callback);
+  sensor.Set_Dropout(nullptr);
+  size_t count = callback->count;
+  sensor.Synchronize(100.1);
+  sensor.Advance(1e-3);
+  ASSERT_EQ(callback->count, count);
+  ASSERT_FALSE(sensor.Get_Released().empty());
+}
+
+/// Callback that replaces itself by another one on its first sample.
+class HandoverCallback : public chrono::vehicle::sensor::ChSensor<double>::OutputCallback {
+ public:
+  HandoverCallback(chrono::vehicle::sensor::ChSensor<double> &sensor,
+                   std::shared_ptr<CountingCallback> next, size_t &count)
+      : sensor(sensor), next(next), count(count) {}
+
+  void OnOutput(const chrono::vehicle::sensor::ChSensorSample<double> &sample) override {
+    ++count;
+    sensor.Add_OutputCallback(next);
+    // The sensor holds the only reference, it must keep this callback alive until it returns
+    sensor.Remove_OutputCallback(sensor_callback);
+    sensor_callback.reset();
+    ASSERT_EQ(count, 1);
+  }
+
+  chrono::vehicle::sensor::ChSensor<double> &sensor;
+  std::shared_ptr<CountingCallback> next;
+  std::shared_ptr<OutputCallback> sensor_callback;
+  size_t &count;
+};
+
+TEST(Sensor, output_callback_modification) {
+  using namespace chrono::vehicle::sensor;
+  // Four samples released per step
+  ChSensor<double> sensor;
+  sensor.Set_SampleRate(1e-3);
+  sensor.Set_SampleMode(SAMPLE_LINEAR);
+  auto first = std::make_shared<CountingCallback>();
+  auto next = std::make_shared<CountingCallback>();
+  size_t handover_count = 0;
+  auto handover = std::make_shared<HandoverCallback>(sensor, next, handover_count);
+  handover->sensor_callback = handover;
+  sensor.Add_OutputCallback(first);
+  sensor.Add_OutputCallback(handover);
+  handover.reset();
+
+  for (int i = 0; i < 3; ++i) {
+    double time = i * 4e-3;
+    sensor.Set_Input(time);
+    sensor.Synchronize(time);
+    sensor.Advance(4e-3);
+  }
+  // The added callback receives the samples after the one that added it
+  ASSERT_EQ(handover_count, 1);
+  ASSERT_EQ(first->count, 9);
+  ASSERT_EQ(next->count, 8);
+}
+
+TEST(SensorChannel, wraparound) {
+  chrono::vehicle::sensor::ChSensorChannel<int> channel(5);
+  ASSERT_EQ(channel.Capacity(), 8);
+  int value;
+  ASSERT_FALSE(channel.Pop(value));
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 8; ++i) {
+      ASSERT_TRUE(channel.Push(round * 8 + i));
+    }
+    ASSERT_FALSE(channel.Push(-1));
+    int values[5];
+    ASSERT_EQ(channel.Pop(values, 5), 5);
+    ASSERT_EQ(values[4], round * 8 + 4);
+    for (int i = 5; i < 8; ++i) {
+      ASSERT_TRUE(channel.Pop(value));
+      ASSERT_EQ(value, round * 8 + i);
+    }
+    ASSERT_TRUE(channel.Empty());
+  }
+  ASSERT_EQ(channel.Get_Overflows(), 10);
+}
+
+TEST(SensorChannel, threaded_consumer) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChVector<>> sensor;
+  sensor.Set_SampleRate(1e-4);
+  sensor.Set_SampleMode(SAMPLE_LINEAR);
+  auto channel = std::make_shared<ChSensorChannel<ChSensorSample<chrono::ChVector<>>>>(256);
+  sensor.Add_OutputChannel(channel);
+
+  std::atomic<bool> done(false);
+  size_t consumed = 0;
+  bool ordered = true;
+  bool consistent = true;
+  std::thread consumer([&]() {
+    ChSensorSample<chrono::ChVector<>> samples[64];
+    double last = -1.;
+    while (true) {
+      bool finished = done.load();
+      size_t count = channel->Pop(samples, 64);
+      for (size_t i = 0; i < count; ++i) {
+        ordered = ordered && samples[i].time > last;
+        auto error = samples[i].value - chrono::ChVector<>(samples[i].time, -samples[i].time, 1.);
+        consistent = consistent && error.Length() < 1e-9;
+        last = samples[i].time;
+      }
+      consumed += count;
+      if (finished && count == 0)
+        break;
+    }
+  });
+
+  size_t released = 0;
+  for (int i = 0; i <= 20000; ++i) {
+    double time = i * 1e-3;
+    sensor.Set_Input(chrono::ChVector<>(time, -time, 1.));
+    sensor.Synchronize(time);
+    sensor.Advance(1e-3);
+    released += sensor.Get_Released().size();
+  }
+  done = true;
+  consumer.join();
+
+  ASSERT_TRUE(ordered);
+  ASSERT_TRUE(consistent);
+  ASSERT_EQ(released, 200001);
+  ASSERT_EQ(consumed + channel->Get_Overflows(), released);
+}
+
+TEST(SensorShm, publish_subscribe) {
+  using namespace chrono::vehicle::sensor;
+  std::string name = "/chrono_sensor_test_" + std::to_string(getpid());
+  ChSensor<chrono::ChVector<>> sensor;
+  sensor.Set_SampleRate(1e-3);
+  sensor.Set_Delay(2e-3);
+  auto publisher = std::make_shared<ChSensorShmPublisher<chrono::ChVector<>>>();
+  ASSERT_TRUE(publisher->Open(name, 64));
+  sensor.Add_OutputCallback(publisher);
+
+  ChSensorShmSubscriber subscriber;
+  ASSERT_FALSE(subscriber.Open(name + "_missing"));
+  ASSERT_TRUE(subscriber.Open(name));
+  ASSERT_EQ(subscriber.Get_Dim(), 3);
+
+  auto run = [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      double time = i * 1e-3;
+      sensor.Set_Input(chrono::ChVector<>(time, 2. * time, 3. * time));
+      sensor.Synchronize(time);
+      sensor.Advance(1e-3);
+    }
+  };
+
+  ChSensorShmSample samples[128];
+  run(0, 50);
+  size_t count = subscriber.Read(samples, 128);
+  ASSERT_EQ(count, 47);
+  for (size_t k = 0; k < count; ++k) {
+    ASSERT_EQ(samples[k].index, k);
+    ASSERT_NEAR(samples[k].time, (k + 1) * 1e-3, 1e-12);
+    ASSERT_NEAR(samples[k].release, samples[k].time + 2e-3, 1e-12);
+    ASSERT_NEAR(samples[k].value[1], 2. * samples[k].time, 1e-12);
+    ASSERT_EQ(samples[k].value[3], 0.);
+  }
+
+  // A slow subscriber skips the samples the ring has overwritten
+  run(50, 250);
+  count = subscriber.Read(samples, 128);
+  ASSERT_EQ(count, 64);
+  ASSERT_EQ(subscriber.Get_Lost(), 200 - 64);
+  ASSERT_EQ(samples[0].index, 247 - 64);
+  ASSERT_EQ(samples[63].index, 246);
+  ASSERT_EQ(subscriber.Read(samples, 128), 0);
+
+  // Concurrent reads are consistent
+  std::atomic<bool> done(false);
+  bool consistent = true;
+  std::thread reader([&]() {
+    ChSensorShmSubscriber concurrent;
+    concurrent.Open(name);
+    ChSensorShmSample batch[16];
+    while (!done.load()) {
+      size_t n = concurrent.Read(batch, 16);
+      for (size_t k = 0; k < n; ++k) {
+        consistent = consistent && batch[k].value[2] == 3. * batch[k].value[0]
+            && std::abs(batch[k].value[0] - batch[k].time) < 1e-9;
+      }
+    }
+  });
+  run(250, 50000);
+  done = true;
+  reader.join();
+  ASSERT_TRUE(consistent);
+  ASSERT_TRUE(ChSensorShmRegion::Unlink(name));
+}
+
+TEST(SensorShm, dead_publisher) {
+  using namespace chrono::vehicle::sensor;
+  std::string name = "/chrono_sensor_test_dead_" + std::to_string(getpid());
+  ChSensorShmRegion region;
+  ASSERT_TRUE(region.Create(name, 1, 4));
+  ChSensorShmHeader *header = region.Get_Header();
+  ChSensorShmRecord *records = region.Get_Records();
+  auto write = [&](uint64_t n, bool complete) {
+    ChSensorShmRecord &record = records[n & 3];
+    record.seq.fetch_add(1);
+    record.index.store(n);
+    record.time.store(n * 1e-3);
+    if (complete)
+      record.seq.fetch_add(1);
+  };
+  for (uint64_t n = 0; n < 4; ++n) {
+    write(n, true);
+  }
+  header->count.store(4);
+
+  // The publisher dies while overwriting the oldest record: the subscriber gives up instead of spinning
+  write(4, false);
+  ChSensorShmSubscriber subscriber;
+  ASSERT_TRUE(subscriber.Open(name));
+  ChSensorShmSample samples[8];
+  ASSERT_EQ(subscriber.Read(samples, 8), 0);
+
+  // Once written but not counted, the record is overwritten and its sample lost
+  records[0].seq.fetch_add(1);
+  ASSERT_EQ(subscriber.Read(samples, 8), 3);
+  ASSERT_EQ(samples[0].index, 1);
+  ASSERT_EQ(subscriber.Get_Lost(), 1);
+  ASSERT_TRUE(ChSensorShmRegion::Unlink(name));
+}
+
+TEST(SensorShm, recreate) {
+  using namespace chrono::vehicle::sensor;
+  std::string name = "/chrono_sensor_test_recreate_" + std::to_string(getpid());
+  ChSensorShmWriter writer;
+  ASSERT_TRUE(writer.Create(name, 1, 64));
+  double value = 0.;
+  for (int i = 0; i < 40; ++i) {
+    value = i;
+    writer.Write(i * 1e-3, i * 1e-3, &value);
+  }
+  ChSensorShmSubscriber subscriber;
+  ASSERT_TRUE(subscriber.Open(name));
+  ChSensorShmSample samples[64];
+  ASSERT_EQ(subscriber.Read(samples, 30), 30);
+
+  // Replaced by a smaller, empty region while the subscriber maps the old one: its stream stays readable
+  ChSensorShmWriter replacement;
+  ASSERT_TRUE(replacement.Create(name, 1, 4));
+  value = -1.;
+  replacement.Write(1., 1., &value);
+  ASSERT_EQ(subscriber.Read(samples, 64), 10);
+  ASSERT_EQ(samples[9].value[0], 39.);
+  ASSERT_EQ(subscriber.Read(samples, 64), 0);
+  ASSERT_EQ(subscriber.Get_Lost(), 0);
+
+  // Opening the name again follows the new region
+  ASSERT_TRUE(subscriber.Open(name));
+  ASSERT_EQ(subscriber.Read(samples, 64), 1);
+  ASSERT_EQ(samples[0].value[0], -1.);
+  ASSERT_EQ(subscriber.Get_Lost(), 0);
+  ASSERT_TRUE(ChSensorShmRegion::Unlink(name));
+}
+
+TEST(Sensor, snapshot_resume) {
+  using namespace chrono::vehicle::sensor;
+  using chrono::ChVector;
+  auto make_sensor = []() {
+    auto sensor = std::make_shared<ChSensor<ChVector<>>>();
+    sensor->Set_SampleRate(2e-3);
+    sensor->Set_Delay(4e-3);
+    sensor->Set_SampleMode(SAMPLE_HERMITE);
+    auto filter = std::make_shared<ChFunction_SensorFilter<ChVector<>>>();
+    filter->Set_Decimation(1e-3, 2e-3, 9);
+    sensor->Add_Transform(filter);
+    std::vector<double> table{-9., 0., 11.};
+    sensor->Add_Transform(std::make_shared<ChFunction_SensorTable<ChVector<>>>(-10., 10., table));
+    sensor->Add_Transform(std::make_shared<ChFunction_SensorGaussMarkov<ChVector<>>>(ChVector<>(0.1), 0.5));
+    sensor->Add_Transform(std::make_shared<ChFunction_SensorNoise<ChVector<>>>(ChVector<>(0.), ChVector<>(0.05)));
+    sensor->Add_Transform(std::make_shared<ChFunction_SensorBias<ChVector<>>>(ChVector<>(0.2)));
+    sensor->Add_Transform(std::make_shared<ChFunction_SensorDigitize<ChVector<>>>(16., ChVector<>(40.)));
+    sensor->Set_Latency(std::make_shared<ChSensorLatency>(LATENCY_EXPONENTIAL, 3e-3));
+    sensor->Set_DeliveryPolicy(DELIVER_REORDER);
+    sensor->Set_Dropout(std::make_shared<ChSensorDropout>(0.05));
+    return sensor;
+  };
+  auto run = [](ChSensor<ChVector<>> &sensor, int begin, int end, std::vector<ChSensorSample<ChVector<>>> &out) {
+    for (int i = begin; i < end; ++i) {
+      double time = i * 1e-3;
+      sensor.Set_Input(ChVector<>(sin(time), cos(3. * time), time));
+      sensor.Synchronize(time);
+      sensor.Advance(1e-3);
+      out.insert(out.end(), sensor.Get_Released().begin(), sensor.Get_Released().end());
+    }
+  };
+
+  auto original = make_sensor();
+  std::vector<ChSensorSample<ChVector<>>> expected, resumed;
+  run(*original, 0, 1000, expected);
+  ChSensorSnapshot snapshot;
+  original->SnapshotOut(snapshot);
+  std::string filename = "sensor_snapshot_test.bin";
+  ASSERT_TRUE(snapshot.Save(filename));
+  expected.clear();
+  run(*original, 1000, 2000, expected);
+
+  // A fresh sensor with differently seeded generators continues exactly like the original
+  auto restored = make_sensor();
+  ChSensorSnapshot loaded;
+  ASSERT_TRUE(loaded.Load(filename));
+  std::remove(filename.c_str());
+  ASSERT_EQ(loaded.Size(), snapshot.Size());
+  ASSERT_TRUE(restored->SnapshotIn(loaded));
+  run(*restored, 1000, 2000, resumed);
+  ASSERT_GT(expected.size(), 400);
+  ASSERT_EQ(resumed.size(), expected.size());
+  for (size_t k = 0; k < expected.size(); ++k) {
+    ASSERT_EQ(resumed[k].time, expected[k].time);
+    ASSERT_EQ(resumed[k].release, expected[k].release);
+    ASSERT_EQ(resumed[k].value, expected[k].value);
+  }
+  ASSERT_EQ(restored->Get_DroppedCount(), original->Get_DroppedCount());
+
+  // Mismatching configurations and truncated snapshots are rejected
+  ChSensor<ChVector<>> other;
+  snapshot.Rewind();
+  ASSERT_FALSE(other.SnapshotIn(snapshot));
+  auto data = snapshot.Get_Data();
+  data.resize(data.size() / 2);
+  ChSensorSnapshot truncated;
+  truncated.Set_Data(data);
+  ASSERT_FALSE(make_sensor()->SnapshotIn(truncated));
+}
+
+TEST(Sensor, published_state) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChQuaternion<>> sensor;
+  sensor.Set_SampleRate(2e-3);
+  sensor.Set_Delay(4e-3);
+  ASSERT_EQ(sensor.Get_State().version, 0);
+
+  std::atomic<bool> done(false);
+  bool consistent = true;
+  uint64_t reads = 0;
+  std::thread reader([&]() {
+    uint64_t last = 0;
+    // Read at least once, the writer may finish before the reader is scheduled
+    while (!done.load() || reads == 0) {
+      auto state = sensor.Get_State();
+      if (state.version == 0)
+        continue;
+      // Every published field belongs to the same step
+      consistent = consistent && state.version >= last && state.input.e0() == state.time
+          && state.input.e1() == 2. * state.time && state.input.e3() == -state.time
+          && state.output_time <= state.time + 1e-9;
+      if (state.output_time > 0.) {
+        consistent = consistent && std::abs(state.output.e0() - (state.output_time - 4e-3)) < 1e-12
+            && state.output.e2() == 3. * state.output.e0();
+      }
+      last = state.version;
+      ++reads;
+    }
+  });
+  for (int i = 0; i < 200000; ++i) {
+    double time = i * 1e-3;
+    sensor.Set_Input(chrono::ChQuaternion<>(time, 2. * time, 3. * time, -time));
+    sensor.Synchronize(time);
+    sensor.Advance(1e-3);
+  }
+  done = true;
+  reader.join();
+  ASSERT_TRUE(consistent);
+  ASSERT_GT(reads, 0);
+  ASSERT_EQ(sensor.Get_State().version, 200000);
+  ASSERT_EQ(sensor.Get_State().output, sensor.Get_Output());
+}
+
+TEST(SensorHistory, lookup) {
+  using namespace chrono::vehicle::sensor;
+  ChSensorHistory<double> history(1.);
+  double value;
+  ASSERT_EQ(history.Find(0.), -1);
+  ASSERT_FALSE(history.Get_Value(0., value));
+  for (int i = 0; i < 10000; ++i) {
+    history.Push(i * 0.01, 3. * i);
+  }
+  // Only the horizon is kept
+  ASSERT_EQ(history.Size(), 101);
+  ASSERT_NEAR(history.Get_OldestTime(), 98.99, 1e-9);
+  ASSERT_EQ(history.Find(98.), -1);
+  ASSERT_EQ(history.Find(99.5), 51);
+  ASSERT_EQ(history.Find(1000.), 100);
+  ASSERT_TRUE(history.Get_Value(99.505, value));
+  ASSERT_NEAR(value, 3. * 9950.5, 1e-6);
+  ASSERT_TRUE(history.Get_Value(99.505, value, false));
+  ASSERT_NEAR(value, 3. * 9950, 1e-9);
+  ASSERT_FALSE(history.Get_Value(100., value));
+
+  // Irregular spacing uses the binary search, late values are inserted in order
+  ChSensorHistory<chrono::ChVector<>> irregular(10.);
+  for (int i = 0; i < 50; ++i) {
+    irregular.Push(i * i * 1e-3, chrono::ChVector<>(i));
+  }
+  irregular.Push(0.0105, chrono::ChVector<>(-1.));
+  for (size_t i = 1; i < irregular.Size(); ++i) {
+    ASSERT_LE(irregular[i - 1].time, irregular[i].time);
+  }
+  ASSERT_EQ(irregular.Find(0.0105), 4);
+  ASSERT_EQ(irregular.Find(1.5), 39);
+}
+
+TEST(Sensor, history) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<double> sensor;
+  sensor.Set_SampleRate(1e-2);
+  sensor.Set_Delay(3e-2);
+  sensor.Set_HistoryHorizon(0.5);
+  for (int i = 0; i <= 100000; ++i) {
+    double time = i * 1e-3;
+    sensor.Set_Input(2. * time);
+    sensor.Synchronize(time);
+    sensor.Advance(1e-3);
+  }
+  auto &inputs = sensor.Get_InputHistory();
+  auto &outputs = sensor.Get_OutputHistory();
+  ASSERT_EQ(inputs.Size(), 501);
+  ASSERT_NEAR(outputs.Get_NewestTime(), 100. - 3e-2, 1e-2);
+  ASSERT_LE(outputs.Size(), 52);
+  double value;
+  ASSERT_TRUE(outputs.Get_Value(99.8, value));
+  ASSERT_NEAR(value, 2. * 99.8, 1e-9);
+  ASSERT_TRUE(inputs.Get_Value(99.7005, value));
+  ASSERT_NEAR(value, 2. * 99.7005, 1e-9);
+}
+
+TEST(SensorTrace, decimation) {
+  using namespace chrono::vehicle::sensor;
+  ChSensorTrace trace(64, 6);
+  const size_t count = 100000;
+  double sum = 0.;
+  for (size_t i = 0; i < count; ++i) {
+    double time = i * 1e-3;
+    double value = std::sin(time) + (i == 31415 ? 5. : 0.) - (i == 77777 ? 3. : 0.);
+    sum += value;
+    trace.Add(time, value);
+  }
+  ASSERT_EQ(trace.Get_Count(), count);
+  ASSERT_EQ(trace.Get_Levels(), 6);
+
+  // The whole run at low resolution keeps the peaks and the mean
+  for (size_t points : {1, 7, 50, 1000}) {
+    auto buckets = trace.Get_Buckets(points);
+    ASSERT_LE(buckets.size(), points);
+    ASSERT_GE(buckets.size(), std::min<size_t>(points, 32));
+    size_t total = 0;
+    double total_sum = 0.;
+    double min = 1e300;
+    double max = -1e300;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      total += buckets[i].count;
+      total_sum += buckets[i].sum;
+      min = std::min(min, buckets[i].min);
+      max = std::max(max, buckets[i].max);
+      if (i > 0) {
+        ASSERT_LT(buckets[i - 1].t_end, buckets[i].t_start);
+      }
+    }
+    ASSERT_EQ(total, count);
+    ASSERT_NEAR(total_sum, sum, 1e-6);
+    ASSERT_EQ(buckets.front().t_start, 0.);
+    ASSERT_EQ(buckets.back().t_end, (count - 1) * 1e-3);
+    ASSERT_EQ(max, std::sin(31.415) + 5.);
+    ASSERT_EQ(min, std::sin(77.777) - 3.);
+  }
+
+  // The most recent samples are kept at full resolution
+  auto recent = trace.Get_Buckets(100, 99.95);
+  ASSERT_EQ(recent.size(), 50);
+  for (size_t i = 0; i < recent.size(); ++i) {
+    ASSERT_EQ(recent[i].count, 1);
+    ASSERT_EQ(recent[i].sum, std::sin((count - 50 + i) * 1e-3));
+  }
+
+  // The envelope has the peak at its instant
+  chrono::ChFunction_Recorder recorder;
+  trace.Fill_Recorder(recorder, 20, TRACE_ENVELOPE, 30., 40.);
+  bool peak = false;
+  for (auto &point : recorder.pts) {
+    peak = peak || (point.first == 31.415 && point.second == std::sin(31.415) + 5.);
+  }
+  ASSERT_TRUE(peak);
+}
+
+TEST(SensorCsvWriter, stream_compatible) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_csv_test.csv";
+  std::ostringstream expected;
+  {
+    // Small blocks to cross the buffer boundary within a line
+    ChSensorCsvWriter writer(100, 1e9);
+    ASSERT_TRUE(writer.Open(filename));
+    for (int i = 0; i < 1000; ++i) {
+      double value = std::pow(-1.7, i % 40) * std::sin(i) * 1e-3;
+      chrono::ChVector<> vector(value, 1e6 * i, -i);
+      chrono::ChQuaternion<> quaternion(0., value * value, 1. / (i + 1), 100000.);
+      writer.Write(i * 1e-3).Write(value).Write(vector).Write(quaternion);
+      ASSERT_TRUE(writer.End_Line());
+      expected << i * 1e-3 << ", " << value << ", " << vector << ", " << quaternion << "\n";
+    }
+    ASSERT_EQ(writer.Get_BytesWritten(), expected.str().size());
+  }
+  std::ifstream file(filename);
+  std::stringstream written;
+  written << file.rdbuf();
+  ASSERT_EQ(written.str(), expected.str());
+  std::remove(filename.c_str());
+
+  // Shortest round trip precision
+  {
+    ChSensorCsvWriter writer;
+    writer.Set_Precision(0);
+    writer.Set_Delimiter(",");
+    ASSERT_TRUE(writer.Open(filename));
+    writer.Write(0.1).Write(1. / 3.).Write(-2.5e-300);
+    writer.End_Line();
+  }
+  std::ifstream exact(filename);
+  std::string line;
+  std::getline(exact, line);
+  ASSERT_EQ(line, "0.1,0.3333333333333333,-2.5e-300");
+  std::remove(filename.c_str());
+
+  // Precisions beyond a double are clamped, so every number fits the space reserved in the buffer
+  {
+    ChSensorCsvWriter writer(100, 1e9);
+    writer.Set_Precision(40);
+    ASSERT_EQ(writer.Get_Precision(), 17);
+    ASSERT_TRUE(writer.Open(filename));
+    for (int i = 0; i < 20; ++i) {
+      writer.Write(-1.2345678901234567e-308);
+      writer.End_Line();
+    }
+  }
+  std::ifstream clamped(filename);
+  for (int i = 0; i < 20; ++i) {
+    std::getline(clamped, line);
+    ASSERT_EQ(line, "-1.2345678901234567e-308");
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(Sensor, log) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_log_test.csv";
+  ChSensor<chrono::ChVector<>> sensor;
+  ASSERT_FALSE(sensor.Log(0.));
+  ASSERT_TRUE(sensor.LogInit(filename));
+  for (int i = 0; i < 10; ++i) {
+    sensor.Set_Input(chrono::ChVector<>(i, 0.5, -i));
+    sensor.Synchronize(i * 1e-3);
+    sensor.Advance(1e-3);
+    ASSERT_TRUE(sensor.Log(i * 1e-3));
+  }
+  ASSERT_TRUE(sensor.LogFlush());
+  std::ifstream file(filename);
+  std::string line;
+  std::getline(file, line);
+  ASSERT_EQ(line, "Time, Input, Output");
+  for (int i = 0; i < 10; ++i) {
+    std::getline(file, line);
+  }
+  ASSERT_EQ(line, "0.009, 9  0.5  -9, 9  0.5  -9");
+  std::remove(filename.c_str());
+}
+
+TEST(Sensor, log_policies) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_log_policy_test.csv";
+  const int steps = 10000;
+  auto input = [](int i) { return 3. * std::sin(i * 1e-3) + 1e-4 * std::sin(i); };
+  auto run = [&](LogPolicy policy, double parameter, std::vector<double> &outputs) {
+    ChSensor<double> sensor;
+    sensor.Add_Transform(std::make_shared<ChFunction_SensorDigitize<double>>(8., 10.));
+    sensor.Set_LogPolicy(policy, parameter);
+    sensor.Get_LogWriter().Set_Precision(0);
+    EXPECT_TRUE(sensor.LogInit(filename));
+    outputs.clear();
+    for (int i = 0; i < steps; ++i) {
+      sensor.Set_Input(input(i));
+      sensor.Synchronize(i * 1e-3);
+      sensor.Advance(1e-3);
+      EXPECT_TRUE(sensor.Log(i * 1e-3));
+      outputs.push_back(sensor.Get_Output());
+    }
+  };
+  auto read = [&](std::vector<std::vector<double>> &lines) {
+    std::ifstream file(filename);
+    std::string line;
+    std::getline(file, line);
+    lines.clear();
+    while (std::getline(file, line)) {
+      std::vector<double> fields;
+      std::istringstream stream(line);
+      std::string field;
+      while (std::getline(stream, field, ','))
+        fields.push_back(std::stod(field));
+      lines.push_back(fields);
+    }
+  };
+  std::vector<double> outputs;
+  std::vector<std::vector<double>> lines;
+
+  // Every change is recorded, the runs reconstruct the output exactly
+  run(LOG_ON_CHANGE, 0., outputs);
+  read(lines);
+  std::vector<double> reconstructed;
+  for (auto &line : lines) {
+    ASSERT_EQ(line.size(), 4);
+    reconstructed.insert(reconstructed.end(), static_cast<size_t>(line[3]), line[2]);
+  }
+  ASSERT_EQ(reconstructed, outputs);
+  ASSERT_LT(lines.size(), steps / 10);
+  ASSERT_EQ(lines[1][0], lines[0][3] * 1e-3);
+
+  // A deadband keeps the output within the deadband of the logged runs
+  size_t changes = lines.size();
+  run(LOG_ON_CHANGE, 2., outputs);
+  read(lines);
+  ASSERT_LT(lines.size(), changes / 2);
+  size_t step = 0;
+  for (auto &line : lines) {
+    for (size_t i = 0; i < line[3]; ++i, ++step) {
+      ASSERT_LE(std::abs(outputs[step] - line[2]), 2. * 10. / 256. + 1e-12);
+    }
+  }
+  ASSERT_EQ(step, steps);
+
+  run(LOG_EVERY_NTH, 7., outputs);
+  read(lines);
+  ASSERT_EQ(lines.size(), (steps + 6) / 7);
+  ASSERT_EQ(lines[3][2], outputs[21]);
+
+  run(LOG_RATE, 0.01, outputs);
+  read(lines);
+  ASSERT_EQ(lines.size(), steps / 10);
+  for (size_t i = 0; i < lines.size(); ++i) {
+    ASSERT_NEAR(lines[i][0], i * 0.01, 1e-12);
+  }
+  std::remove(filename.c_str());
+}
+
+/// Compares the stream based log, as formerly written by ChSensor::Log(), with the buffered writer.
+/// Run with --gtest_also_run_disabled_tests.
+TEST(SensorCsvWriter, DISABLED_benchmark) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_csv_benchmark.csv";
+  const int lines = 200000;
+  auto value = [](int i) { return chrono::ChVector<>(std::sin(i), std::cos(i), 1e-3 * i); };
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::ofstream(filename.c_str(), std::ios::out) << "Time, Input, Output" << std::endl;
+    for (int i = 0; i < lines; ++i) {
+      std::ofstream ofile(filename.c_str(), std::ios::app);
+      ofile << i * 1e-3 << ", " << value(i) << ", " << value(i + 1) << std::endl;
+    }
+  }
+  double reopened = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  {
+    std::ofstream ofile(filename.c_str(), std::ios::out);
+    ofile << "Time, Input, Output" << std::endl;
+    for (int i = 0; i < lines; ++i) {
+      ofile << i * 1e-3 << ", " << value(i) << ", " << value(i + 1) << std::endl;
+    }
+  }
+  double stream = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  {
+    ChSensorCsvWriter writer;
+    writer.Open(filename);
+    writer.Write("Time").Write("Input").Write("Output").End_Line();
+    for (int i = 0; i < lines; ++i) {
+      writer.Write(i * 1e-3).Write(value(i)).Write(value(i + 1)).End_Line();
+    }
+  }
+  double buffered = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::remove(filename.c_str());
+
+  std::cout << "Lines per second, reopened stream: " << lines / reopened << ", open stream: " << lines / stream
+            << ", buffered writer: " << lines / buffered << std::endl;
+  ASSERT_LT(buffered, stream);
+}
+
+TEST(SensorStatistics, streaming) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChVector<>> sensor;
+  auto statistics = std::make_shared<ChSensorStatistics<chrono::ChVector<>>>();
+  sensor.Add_OutputCallback(statistics);
+  std::vector<chrono::ChVector<>> outputs;
+  for (int i = 0; i < 10000; ++i) {
+    // Large offset, where the naive sum of squares cancels
+    sensor.Set_Input(chrono::ChVector<>(1e9 + std::sin(i), std::cos(0.1 * i), i % 7));
+    sensor.Synchronize(i * 1e-3);
+    sensor.Advance(1e-3);
+    outputs.push_back(sensor.Get_Output());
+  }
+  ASSERT_EQ(statistics->Get_Count(), outputs.size());
+  // Two pass reference
+  chrono::ChVector<> mean(0.);
+  for (auto &output : outputs)
+    mean += output;
+  mean /= outputs.size();
+  chrono::ChVector<> variance(0.);
+  for (auto &output : outputs) {
+    for (int i = 0; i < 3; ++i)
+      variance[i] += (output[i] - mean[i]) * (output[i] - mean[i]);
+  }
+  variance /= outputs.size() - 1;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NEAR(statistics->Get_Mean()[i], mean[i], 1e-12 * std::abs(mean[i]) + 1e-12);
+    ASSERT_NEAR(statistics->Get_Variance()[i], variance[i], 1e-6 * variance[i]);
+    ASSERT_NEAR(statistics->Get_Stddev()[i], std::sqrt(variance[i]), 1e-6);
+  }
+  ASSERT_EQ(statistics->Get_Min()[2], 0.);
+  ASSERT_EQ(statistics->Get_Max()[2], 6.);
+
+  // Merged halves agree with the whole
+  ChSensorStatistics<chrono::ChVector<>> first, second;
+  for (size_t i = 0; i < outputs.size(); ++i)
+    (i < 3000 ? first : second).Add(outputs[i]);
+  first.Merge(second);
+  ASSERT_EQ(first.Get_Count(), outputs.size());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NEAR(first.Get_Mean()[i], statistics->Get_Mean()[i], 1e-12 * std::abs(mean[i]) + 1e-12);
+    ASSERT_NEAR(first.Get_Variance()[i], statistics->Get_Variance()[i], 1e-8 * variance[i]);
+  }
+}
+
+TEST(SensorAllan, deviation) {
+  using namespace chrono::vehicle::sensor;
+  // Against the direct definition over cluster averages
+  std::vector<double> rate;
+  for (int i = 0; i < 200; ++i)
+    rate.push_back(std::sin(0.3 * i) + 0.01 * i * i);
+  auto points = Allan_Deviation(rate, 0.1, 2);
+  ASSERT_EQ(points.size(), 12);
+  for (auto &point : points) {
+    auto m = static_cast<size_t>(std::round(point.tau / 0.1));
+    double sum = 0.;
+    size_t terms = 0;
+    for (size_t k = 0; k + 2 * m <= rate.size(); ++k, ++terms) {
+      double first = 0., second = 0.;
+      for (size_t i = 0; i < m; ++i) {
+        first += rate[k + i];
+        second += rate[k + m + i];
+      }
+      sum += (second - first) * (second - first) / (m * m);
+    }
+    ASSERT_EQ(point.terms, terms);
+    ASSERT_NEAR(point.deviation, std::sqrt(sum / (2. * terms)), 1e-9 * point.deviation);
+  }
+
+  // White rate noise falls with the square root of the cluster time
+  std::default_random_engine gen(42);
+  std::normal_distribution<double> noise(0.5, 0.2);
+  std::vector<chrono::ChVector<>> vectors(1 << 20);
+  for (auto &vector : vectors)
+    vector = chrono::ChVector<>(noise(gen), 0., noise(gen));
+  auto white = Allan_Deviation(&vectors[0][2], vectors.size(), 1e-3, 1, sizeof(chrono::ChVector<>) / sizeof(double));
+  ASSERT_EQ(white.size(), 20);
+  for (size_t k = 0; k < 8; ++k) {
+    ASSERT_NEAR(white[k].tau, 1e-3 * (1 << k), 1e-15);
+    ASSERT_NEAR(white[k].deviation, 0.2 / std::sqrt(1 << k), 0.03 * white[k].deviation);
+  }
+}
+
+TEST(SensorSpectrum, fft) {
+  using namespace chrono::vehicle::sensor;
+  ChSensorFFT fft(100);
+  ASSERT_EQ(fft.Get_Size(), 128);
+  std::vector<std::complex<double>> x(128);
+  for (size_t i = 0; i < x.size(); ++i)
+    x[i] = std::complex<double>(std::sin(0.3 * i * i), std::cos(i));
+  auto y = x;
+  fft.Forward(y.data());
+  for (size_t k = 0; k < x.size(); ++k) {
+    std::complex<double> dft(0.);
+    for (size_t n = 0; n < x.size(); ++n)
+      dft += x[n] * std::polar(1., -2. * CH_C_PI * double(k * n % x.size()) / x.size());
+    ASSERT_NEAR(std::abs(y[k] - dft), 0., 1e-10);
+  }
+}
+
+TEST(SensorSpectrum, welch) {
+  using namespace chrono::vehicle::sensor;
+  const double rate = 1000.;
+  const double sigma = 0.3;
+  std::default_random_engine gen(7);
+  std::normal_distribution<double> noise(0., sigma);
+  std::vector<double> signal(1 << 18);
+  for (size_t i = 0; i < signal.size(); ++i)
+    signal[i] = noise(gen) + std::sin(2. * CH_C_PI * 125. * i / rate);
+
+  ChSensorWelch welch(1000, rate);
+  welch.Add(signal.data(), signal.size());
+  ASSERT_EQ(welch.Get_Bins(), 513);
+  ASSERT_EQ(welch.Get_Segments(), signal.size() / 512 - 1);
+  auto psd = welch.Get_PSD();
+  // White noise level and the sine peak, whose power is the integral of the PSD around it
+  double level = 0.;
+  size_t count = 0;
+  double total = 0.;
+  for (size_t k = 0; k < psd.size(); ++k) {
+    total += psd[k] * rate / 1024.;
+    if (std::abs(welch.Get_Frequency(k) - 125.) > 10.) {
+      level += psd[k];
+      ++count;
+    }
+  }
+  ASSERT_NEAR(level / count, 2. * sigma * sigma / rate, 0.03 * 2. * sigma * sigma / rate);
+  ASSERT_NEAR(total, sigma * sigma + 0.5, 0.01);
+  ASSERT_EQ(std::max_element(psd.begin(), psd.end()) - psd.begin(), 128);
+
+  // Streaming in odd blocks with a stride gives the same estimate
+  std::vector<double> interleaved(2 * signal.size());
+  for (size_t i = 0; i < signal.size(); ++i)
+    interleaved[2 * i + 1] = signal[i];
+  ChSensorWelch streamed(1024, rate);
+  for (size_t i = 0; i < signal.size(); i += 777)
+    streamed.Add(interleaved.data() + 2 * i + 1, std::min<size_t>(777, signal.size() - i), 2);
+  ASSERT_EQ(streamed.Get_Segments(), welch.Get_Segments());
+  auto streamed_psd = streamed.Get_PSD();
+  for (size_t k = 0; k < psd.size(); ++k)
+    ASSERT_NEAR(streamed_psd[k], psd[k], 1e-12 * psd[k]);
+}
+
+TEST(SensorLogReader, csv_and_binary) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_reader_test.csv";
+  {
+    ChSensor<chrono::ChVector<>> sensor;
+    sensor.Get_LogWriter().Set_Precision(0);
+    ASSERT_TRUE(sensor.LogInit(filename));
+    for (int i = 0; i < 1000; ++i) {
+      sensor.Set_Input(chrono::ChVector<>(i, -0.1 * i, 1e-9 * i));
+      sensor.Synchronize(i * 1e-3);
+      sensor.Advance(1e-3);
+      sensor.Log(i * 1e-3);
+    }
+  }
+  ChSensorLogReader reader;
+  ASSERT_TRUE(reader.Open(filename));
+  ASSERT_FALSE(reader.Is_Binary());
+  ASSERT_EQ(reader.Get_Columns(), 7);
+  ASSERT_EQ(reader.Get_Names()[0], "Time");
+  ASSERT_EQ(reader.Get_Names()[2], "Input[1]");
+  ASSERT_EQ(reader.Get_Names()[6], "Output[2]");
+  std::vector<double> rows;
+  std::vector<double> all;
+  while (size_t count = reader.Read(rows, 300)) {
+    ASSERT_LE(count, 300);
+    ASSERT_EQ(rows.size(), count * 7);
+    all.insert(all.end(), rows.begin(), rows.end());
+  }
+  ASSERT_EQ(all.size(), 7000);
+  ASSERT_EQ(reader.Get_Skipped(), 0);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(all[7 * i], i * 1e-3);
+    ASSERT_EQ(all[7 * i + 2], -0.1 * i);
+    ASSERT_EQ(all[7 * i + 6], 1e-9 * i);
+  }
+
+  {
+    std::ofstream binary(filename, std::ios::binary);
+    ChSensorLogReader::Write_BinaryHeader(binary, 7);
+    binary.write(reinterpret_cast<const char *>(all.data()), all.size() * sizeof(double));
+  }
+  ASSERT_TRUE(reader.Open(filename));
+  ASSERT_TRUE(reader.Is_Binary());
+  ASSERT_EQ(reader.Get_Columns(), 7);
+  ASSERT_EQ(reader.Read(rows, 2000), 1000);
+  ASSERT_EQ(rows, all);
+  ASSERT_EQ(reader.Read(rows, 2000), 0);
+  std::remove(filename.c_str());
+}
+
+TEST(SensorLogReader, run_length) {
+  using namespace chrono::vehicle::sensor;
+  const std::string filename = "chrono_sensor_reader_run_test.csv";
+  const int steps = 2000;
+  std::vector<double> outputs;
+  {
+    ChSensor<double> sensor;
+    sensor.Add_Transform(std::make_shared<ChFunction_SensorDigitize<double>>(8., 10.));
+    sensor.Set_LogPolicy(LOG_ON_CHANGE);
+    sensor.Get_LogWriter().Set_Precision(0);
+    ASSERT_TRUE(sensor.LogInit(filename));
+    for (int i = 0; i < steps; ++i) {
+      sensor.Set_Input(3. * std::sin(i * 1e-2));
+      sensor.Synchronize(i * 1e-3);
+      sensor.Advance(1e-3);
+      sensor.Log(i * 1e-3);
+      outputs.push_back(sensor.Get_Output());
+    }
+  }
+  // The runs are expanded to one row per step and the Count column is dropped
+  ChSensorLogReader reader;
+  ASSERT_TRUE(reader.Open(filename));
+  ASSERT_TRUE(reader.Is_RunLength());
+  ASSERT_EQ(reader.Get_Columns(), 3);
+  ASSERT_EQ(reader.Get_Names()[2], "Output");
+  std::vector<double> rows;
+  std::vector<double> all;
+  while (size_t count = reader.Read(rows, 333)) {
+    ASSERT_EQ(rows.size(), count * 3);
+    all.insert(all.end(), rows.begin(), rows.end());
+  }
+  ASSERT_EQ(all.size(), 3 * steps);
+  ASSERT_EQ(reader.Get_Skipped(), 0);
+  for (int i = 0; i < steps; ++i) {
+    ASSERT_NEAR(all[3 * i], i * 1e-3, 1e-9);
+    ASSERT_EQ(all[3 * i + 2], outputs[i]);
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(SensorMatrix, solve) {
+  using namespace chrono::vehicle::sensor;
+  ChSensorMatrix<4, 4> L;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j <= i; ++j)
+      L(i, j) = i == j ? 2. + i : std::sin(i + 3. * j);
+  }
+  ChSensorMatrix<4, 4> A = L * L.Transpose();
+  ChSensorMatrix<4, 2> X;
+  for (int i = 0; i < 4; ++i) {
+    X(i, 0) = i;
+    X(i, 1) = std::cos(i);
+  }
+  ChSensorMatrix<4, 2> B = A * X;
+  ChSensorMatrix<4, 4> factor = A;
+  ASSERT_TRUE((ChSensorMatrix<4, 4>::Solve_Spd(factor, B)));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NEAR(B(i, 0), X(i, 0), 1e-12);
+    ASSERT_NEAR(B(i, 1), X(i, 1), 1e-12);
+  }
+  ChSensorMatrix<4, 4> indefinite = A - ChSensorMatrix<4, 4>::Identity() * 100.;
+  ASSERT_FALSE((ChSensorMatrix<4, 4>::Solve_Spd(indefinite, B)));
+}
+
+TEST(SensorInsEstimator, circle) {
+  using namespace chrono::vehicle::sensor;
+  using chrono::ChVector;
+  using chrono::ChQuaternion;
+  // Vehicle driving a circle of radius r at yaw rate w, heading along the velocity
+  const double r = 50.;
+  const double w = 0.2;
+  auto position = [&](double t) { return ChVector<>(r * std::sin(w * t), r - r * std::cos(w * t), 0.); };
+  auto velocity = [&](double t) { return ChVector<>(r * w * std::cos(w * t), r * w * std::sin(w * t), 0.); };
+  auto yaw = [&](double t) { return chrono::Q_from_AngAxis(w * t, ChVector<>(0., 0., 1.)); };
+
+  std::default_random_engine gen(3);
+  std::normal_distribution<double> normal(0., 1.);
+  auto noisy = [&](const ChVector<> &v, double stddev) {
+    return v + ChVector<>(normal(gen), normal(gen), normal(gen)) * stddev;
+  };
+
+  ChSensorInsEstimator estimator;
+  estimator.Set_ProcessNoise(0.05, 0.005);
+  // Initial errors of 2 m, 0.5 m/s and 0.1 rad of yaw
+  estimator.Initialize(0., position(0.) + ChVector<>(2., -1., 0.), velocity(0.) + ChVector<>(0.5, 0., 0.),
+                       chrono::Q_from_AngAxis(0.1, ChVector<>(0., 0., 1.)), 3., 1., 0.2);
+  const double imu_step = 1e-3;
+  const double gps_step = 0.1;
+  const double gps_delay = 0.05;
+  const int gps_interval = static_cast<int>(std::lround(gps_step / imu_step));
+  size_t allocated = 0;
+  for (int i = 1; i <= 30000; ++i) {
+    double time = i * imu_step;
+    size_t before = allocations;
+    // Centripetal acceleration towards the left of the vehicle
+    estimator.Set_Acceleration(time, noisy(ChVector<>(0., r * w * w, 0.), 0.05 / std::sqrt(imu_step)));
+    estimator.Set_AngularVelocity(time, noisy(ChVector<>(0., 0., w), 0.005 / std::sqrt(imu_step)));
+    if (i % gps_interval == 0) {
+      // GPS fix delivered late, with the instant it was taken
+      double taken = time - gps_delay;
+      ASSERT_TRUE(estimator.Update_Position(taken, noisy(position(taken), 0.5), 0.5));
+    }
+    allocated += allocations - before;
+  }
+  ASSERT_EQ(allocated, 0);
+  double time = estimator.Get_Time();
+  ASSERT_NEAR(time, 30., 1e-9);
+  ChVector<> position_error = estimator.Get_Position() - position(time);
+  ChVector<> velocity_error = estimator.Get_Velocity() - velocity(time);
+  ChVector<> attitude_error =
+      ChFunction_SensorOrientationNoise::Log_Map(yaw(time).GetConjugate() * estimator.Get_Orientation());
+  ASSERT_LT(position_error.Length(), 0.5);
+  ASSERT_LT(velocity_error.Length(), 0.3);
+  ASSERT_LT(attitude_error.Length(), 0.02);
+  // The errors are consistent with the covariance
+  auto &P = estimator.Get_Covariance();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_LT(std::abs(position_error[i]), 3. * std::sqrt(P(i, i)));
+    ASSERT_LT(std::abs(velocity_error[i]), 3. * std::sqrt(P(3 + i, 3 + i)));
+  }
+  ASSERT_LT(std::abs(attitude_error.z()), 3. * std::sqrt(P(8, 8)));
+
+  // Orientation and velocity measurements
+  ASSERT_TRUE(estimator.Update_Orientation(time, yaw(time), 1e-3));
+  attitude_error =
+      ChFunction_SensorOrientationNoise::Log_Map(yaw(time).GetConjugate() * estimator.Get_Orientation());
+  ASSERT_LT(attitude_error.Length(), 2e-3);
+  ASSERT_TRUE(estimator.Update_Velocity(time, velocity(time), 1e-3));
+  ASSERT_LT((estimator.Get_Velocity() - velocity(time)).Length(), 1e-2);
+}
+
+/// Predict and update cost of the estimator.
+/// Run with --gtest_also_run_disabled_tests.
+TEST(SensorInsEstimator, DISABLED_benchmark) {
+  using namespace chrono::vehicle::sensor;
+  ChSensorInsEstimator estimator;
+  estimator.Initialize(0., chrono::ChVector<>(0.), chrono::ChVector<>(1., 0., 0.),
+                       chrono::ChQuaternion<>(1., 0., 0., 0.), 1., 1., 0.1);
+  const int steps = 1000000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= steps; ++i) {
+    estimator.Set_Acceleration(i * 1e-3, chrono::ChVector<>(0.1, 0., 0.));
+  }
+  double predict = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / steps;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < steps; ++i) {
+    estimator.Update_Position(estimator.Get_Time(), estimator.Get_Position(), 1.);
+  }
+  double update = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / steps;
+  std::cout << "Predict: " << predict * 1e6 << " us, position update: " << update * 1e6 << " us" << std::endl;
+}
+
+TEST(SensorMahony, convergence) {
+  using namespace chrono::vehicle::sensor;
+  using chrono::ChVector;
+  // Vehicle at rest, pitched by 0.2 rad and yawed by 1 rad, in a field pointing north and down
+  auto truth = chrono::Q_from_AngAxis(1., ChVector<>(0., 0., 1.)) * chrono::Q_from_AngAxis(0.2, ChVector<>(0., 1., 0.));
+  ChVector<> acceleration = truth.RotateBack(ChVector<>(0., 0., 9.81));
+  ChVector<> field = truth.RotateBack(ChVector<>(0.2, 0., -0.4));
+  ChVector<> bias(0.01, -0.02, 0.005);
+
+  ChSensorMahony tilt(2., 0.);
+  ChSensorMahony full(2., 0.2);
+  for (int i = 0; i < 100000; ++i) {
+    tilt.Update(1e-3, ChVector<>(0.), acceleration);
+    full.Update(1e-3, bias, acceleration, field);
+  }
+  // Without a magnetometer only the tilt is observable
+  ASSERT_LT((tilt.Get_Orientation().RotateBack(ChVector<>(0., 0., 1.)) - acceleration.GetNormalized()).Length(), 1e-9);
+  ASSERT_LT(ChFunction_SensorOrientationNoise::Log_Map(truth.GetConjugate() * full.Get_Orientation()).Length(), 1e-4);
+  ASSERT_LT((full.Get_Integral() + bias).Length(), 1e-4);
+}
+
+TEST(SensorMahony, bank_consistency) {
+  using namespace chrono::vehicle::sensor;
+  using chrono::ChVector;
+  const size_t count = 257;
+  ChSensorMahonyBank bank(count, 1.5, 0.1);
+  ChSensorMahonyBank bank_aos(count, 1.5, 0.1);
+  std::vector<ChSensorMahony> filters(count, ChSensorMahony(1.5, 0.1));
+  std::vector<ChSensorMahony> filters_mag(count, ChSensorMahony(1.5, 0.1));
+  ChSensorMahonyBank bank_mag(count, 1.5, 0.1);
+  for (size_t i = 0; i < count; ++i) {
+    auto q = chrono::Q_from_AngAxis(0.01 * i, ChVector<>(std::sin(i), std::cos(i), 0.5));
+    bank.Set_Orientation(i, q);
+    bank_aos.Set_Orientation(i, q);
+    bank_mag.Set_Orientation(i, q);
+    filters[i].Set_Orientation(q);
+    filters_mag[i].Set_Orientation(q);
+  }
+  std::vector<double> input[9];
+  for (auto &component : input)
+    component.resize(count);
+  std::vector<ChVector<>> gyro(count), acc(count);
+  for (int step = 0; step < 2000; ++step) {
+    for (size_t i = 0; i < count; ++i) {
+      double t = step * 1e-3 + i;
+      gyro[i] = ChVector<>(0.3 * std::sin(t), 0.2 * std::cos(2. * t), 0.1);
+      // Every 7th vehicle in free fall, without an accelerometer correction
+      acc[i] = i % 7 == 0 ? ChVector<>(0.) : ChVector<>(std::sin(3. * t), 0.5, 9.81);
+      for (int c = 0; c < 3; ++c) {
+        input[c][i] = gyro[i][c];
+        input[3 + c][i] = acc[i][c];
+      }
+      input[6][i] = 0.2;
+      input[7][i] = 0.1 * std::cos(t);
+      input[8][i] = -0.4;
+      filters[i].Update(1e-3, gyro[i], acc[i]);
+      filters_mag[i].Update(1e-3, gyro[i], acc[i], ChVector<>(input[6][i], input[7][i], input[8][i]));
+    }
+    size_t before = allocations;
+    bank.Update(1e-3, input[0].data(), input[1].data(), input[2].data(), input[3].data(), input[4].data(),
+                input[5].data());
+    bank_aos.Update(1e-3, gyro.data(), acc.data());
+    bank_mag.Update(1e-3, input[0].data(), input[1].data(), input[2].data(), input[3].data(), input[4].data(),
+                    input[5].data(), input[6].data(), input[7].data(), input[8].data());
+    ASSERT_EQ(allocations, before);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    auto q = bank.Get_Orientation(i);
+    auto q_mag = bank_mag.Get_Orientation(i);
+    for (int c = 0; c < 4; ++c) {
+      ASSERT_NEAR(q[c], filters[i].Get_Orientation()[c], 1e-12);
+      ASSERT_NEAR(q_mag[c], filters_mag[i].Get_Orientation()[c], 1e-12);
+      ASSERT_EQ(q[c], bank_aos.Get_Orientation(i)[c]);
+      ASSERT_EQ(bank.Get_Orientation(c)[i], q[c]);
+    }
+    ASSERT_NEAR((bank.Get_Integral(i) - filters[i].Get_Integral()).Length(), 0., 1e-12);
+  }
+}
+
+/// Updates per second of the scalar filters and of the bank.
+/// Run with --gtest_also_run_disabled_tests.
+TEST(SensorMahony, DISABLED_benchmark) {
+  using namespace chrono::vehicle::sensor;
+  using chrono::ChVector;
+  const size_t count = 1024;
+  const int steps = 10000;
+  std::vector<ChSensorMahony> filters(count);
+  ChSensorMahonyBank bank(count);
+  std::vector<ChVector<>> gyro(count, ChVector<>(0.1, 0.2, 0.3)), acc(count, ChVector<>(0.1, 0.5, 9.81));
+  std::vector<double> input[6];
+  for (int c = 0; c < 6; ++c)
+    input[c].assign(count, c < 3 ? gyro[0][c] : acc[0][c - 3]);
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step < steps; ++step) {
+    for (size_t i = 0; i < count; ++i)
+      filters[i].Update(1e-3, gyro[i], acc[i]);
+  }
+  double scalar = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int step = 0; step < steps; ++step) {
+    bank.Update(1e-3, input[0].data(), input[1].data(), input[2].data(), input[3].data(), input[4].data(),
+                input[5].data());
+  }
+  double batched = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Updates per second, scalar: " << count * steps / scalar << ", bank: " << count * steps / batched
+            << std::endl;
+  ASSERT_NEAR(bank.Get_Orientation(0)[0], filters[0].Get_Orientation()[0], 1e-9);
+}
+
+TEST(Sensor, allocation_free) {
+  using namespace chrono::vehicle::sensor;
+  for (auto mode : {SAMPLE_STEP, SAMPLE_HERMITE}) {
+    ChSensor<chrono::ChVector<>> sensor;
+    sensor.Set_SampleRate(mode == SAMPLE_STEP ? 1e-2 : 5e-4);
+    sensor.Set_Delay(0.03);
+    sensor.Set_SampleMode(mode);
+    auto filter = std::make_shared<ChFunction_SensorFilter<chrono::ChVector<>>>();
+    filter->Set_Decimation(2e-3, 1e-2, 15);
+    sensor.Add_Transform(filter);
+    sensor.Add_Transform(
+        std::make_shared<ChFunction_SensorGaussMarkov<chrono::ChVector<>>>(chrono::ChVector<>(0.1), 1.));
+    sensor.Add_Transform(
+        std::make_shared<ChFunction_SensorDigitize<chrono::ChVector<>>>(12., chrono::ChVector<>(100.)));
+    sensor.Set_HistoryHorizon(0.5);
+    sensor.Initialize();
+
+    double step = 2e-3;
+    size_t count = 0;
+    auto advance = [&](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        double time = i * step;
+        sensor.Set_Input(chrono::ChVector<>(sin(time), cos(time), 9.81));
+        sensor.Synchronize(time);
+        sensor.Advance(step);
+        count += sensor.Get_Released().size();
+      }
+    };
+    // Warm up to the steady state queue depth
+    advance(0, 100);
+    size_t before = allocations;
+    advance(100, 10100);
+    ASSERT_EQ(allocations - before, 0);
+    ASSERT_GT(count, 0);
+  }
+}
+
+TEST(Sensor, pipeline_folding) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChVector<>> sensor;
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<chrono::ChVector<>>>(chrono::ChVector<>(1., 2., 3.)));
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<chrono::ChVector<>>>(chrono::ChVector<>(-1., 0., 1.)));
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorDigitize<chrono::ChVector<>>>());
+  auto digitize = std::make_shared<ChFunction_SensorDigitize<chrono::ChVector<>>>(8., chrono::ChVector<>(256.));
+  sensor.Add_Transform(digitize);
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<chrono::ChVector<>>>(chrono::ChVector<>(0.)));
+  sensor.Initialize();
+
+  // Two biases fold into one, the zero bit digitizer and zero bias are dropped
+  auto &pipeline = sensor.Get_Pipeline();
+  ASSERT_EQ(pipeline.size(), 2);
+  ASSERT_EQ(pipeline[0]->Get_Type(), FUNCT_BIAS);
+  ASSERT_EQ(pipeline[0]->Get_y(chrono::ChVector<>(0.)), chrono::ChVector<>(0., 2., 4.));
+  ASSERT_EQ(pipeline[1], digitize.get());
+  ASSERT_FALSE(sensor.Get_PipelineDescription().empty());
+
+  sensor.Set_Input(chrono::ChVector<>(10.2, 20.7, 30.));
+  sensor.Synchronize(0.);
+  sensor.Advance(1e-3);
+  ASSERT_EQ(sensor.Get_Output(), chrono::ChVector<>(10., 23., 34.));
+
+  sensor.Set_OptimizePipeline(false);
+  sensor.Initialize();
+  ASSERT_EQ(sensor.Get_Pipeline().size(), 5);
+}
+
+TEST(Sensor, pipeline_subclass) {
+  using namespace chrono::vehicle::sensor;
+  // Inherits the bias type but scales instead of adding
+  class ScaleBias : public ChFunction_SensorBias<double> {
+   public:
+    ScaleBias() : ChFunction_SensorBias<double>(3.) {}
+    double Get_y(const double &x) const override { return x * Get_Bias(); }
+  };
+  ChSensor<double> sensor;
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<>>(1.));
+  auto scale = std::make_shared<ScaleBias>();
+  sensor.Add_Transform(scale);
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<>>(1.));
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorNoise<>>(2., 0.));
+  sensor.Initialize();
+
+  // The subclass splits the run and passes through unchanged
+  auto &pipeline = sensor.Get_Pipeline();
+  ASSERT_EQ(pipeline.size(), 3);
+  ASSERT_EQ(pipeline[1], scale.get());
+  sensor.Set_Input(1.);
+  sensor.Synchronize(0.);
+  sensor.Advance(1e-3);
+  ASSERT_EQ(sensor.Get_Output(), 9.);
+}
+
+TEST(Sensor, pipeline_quaternion) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChQuaternion<>> sensor;
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorDigitize<chrono::ChQuaternion<>>>(0., chrono::ChVector<>(1.)));
+  auto bias = std::make_shared<ChFunction_SensorBias<chrono::ChQuaternion<>>>(chrono::QUNIT);
+  sensor.Add_Transform(bias);
+  sensor.Initialize();
+
+  // Quaternion chains only drop the identity digitizers
+  ASSERT_EQ(sensor.Get_Pipeline().size(), 1);
+  ASSERT_EQ(sensor.Get_Pipeline()[0], bias.get());
+
+  sensor.Set_Input(chrono::QUNIT);
+  sensor.Synchronize(0.);
+  sensor.Advance(1e-3);
+  ASSERT_EQ(sensor.Get_Output(), chrono::QUNIT);
+}
+
+TEST(Sensor, pipeline_noise_folding) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<double> sensor;
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorNoise<>>(0.5, 0.3));
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorBias<>>(1.5));
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorNoise<>>(0., 0.4));
+  sensor.Initialize();
+
+  // Mean and bias fold into a single noise stage with the summed variance
+  ASSERT_EQ(sensor.Get_Pipeline().size(), 1);
+  auto noise = static_cast<ChFunction_SensorNoise<> *>(sensor.Get_Pipeline()[0]);
+  ASSERT_EQ(noise->Get_Type(), FUNCT_NOISE);
+  ASSERT_DOUBLE_EQ(noise->Get_Mean(), 2.);
+  ASSERT_DOUBLE_EQ(noise->Get_Stddev(), 0.5);
+}
+
+TEST(Sensor, pipeline_covariance_folding) {
+  using namespace chrono::vehicle::sensor;
+  ChSensor<chrono::ChVector<>> sensor;
+  auto f_noise =
+      std::make_shared<ChFunction_SensorNoise<chrono::ChVector<>>>(chrono::ChVector<>(0.), chrono::ChVector<>(0.));
+  f_noise->Set_Covariance({1., 0.5, 0., 0.5, 1., 0., 0., 0., 1.});
+  sensor.Add_Transform(f_noise);
+  sensor.Add_Transform(std::make_shared<ChFunction_SensorNoise<chrono::ChVector<>>>(chrono::ChVector<>(1.),
+                                                                                   chrono::ChVector<>(1., 0., 2.)));
+  sensor.Initialize();
+
+  auto &pipeline = sensor.Get_Pipeline();
+  ASSERT_EQ(pipeline.size(), 1);
+  auto fused = static_cast<ChFunction_SensorNoise<chrono::ChVector<>> *>(pipeline[0]);
+  ASSERT_TRUE(fused->Is_Correlated());
+  auto covariance = fused->Get_Covariance();
+  ASSERT_NEAR(covariance[0], 2., 1e-12);
+  ASSERT_NEAR(covariance[1], 0.5, 1e-12);
+  ASSERT_NEAR(covariance[4], 1., 1e-12);
+  ASSERT_NEAR(covariance[8], 5., 1e-12);
+}
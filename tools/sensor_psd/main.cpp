@@ -0,0 +1,194 @@
+// MIT License
+//
+// Copyright (c) 2019 Jelle Spijker
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Welch power spectral densities of recorded sensor traces.
+//
+// Usage: sensor_psd <log> [-s segment] [-r sample_rate] [-c column,...] [-n rows] [-b binary_log] [-o output]
+//
+// The log is read in chunks of rows, in the CSV format of ChSensor::Log() or the binary format of
+// ChSensorLogReader, so traces larger than the memory are processed in constant memory. The first column is the
+// time, from which the sample rate is estimated unless given. The PSD of every other column (or of the selected
+// ones, by index or by name such as "Output[1]") is written as CSV with the frequency in the first column. The runs of
+// a LOG_ON_CHANGE log are expanded by the reader. With -b the log is also converted to the binary format, which is
+// much faster to read again.
+//
+// =============================================================================
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chrono_sensor/ChSensorCsvWriter.h"
+#include "chrono_sensor/ChSensorLogReader.h"
+#include "chrono_sensor/ChSensorSpectrum.h"
+
+using namespace chrono::vehicle::sensor;
+
+/// Parse a whole string as an unsigned number.
+bool Parse_Size(const std::string &text, size_t &value) {
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  char *end = nullptr;
+  value = std::strtoul(text.c_str(), &end, 10);
+  return *end == '\0';
+}
+
+int Usage() {
+  std::cerr << "Usage: sensor_psd <log> [-s segment] [-r sample_rate] [-c column,...] [-n rows] [-b binary_log]"
+               " [-o output]" << std::endl;
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2)
+    return Usage();
+  std::string input = argv[1];
+  std::string output = "psd.csv";
+  std::string binary;
+  size_t segment = 4096;
+  size_t chunk = 1 << 16;
+  double sample_rate = 0.;
+  std::vector<std::string> selected;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    std::string option = argv[i];
+    std::string value = argv[i + 1];
+    if (option == "-s") {
+      if (!Parse_Size(value, segment))
+        return Usage();
+    } else if (option == "-r") {
+      char *end = nullptr;
+      sample_rate = std::strtod(value.c_str(), &end);
+      if (end == value.c_str() || *end != '\0')
+        return Usage();
+    } else if (option == "-n") {
+      if (!Parse_Size(value, chunk))
+        return Usage();
+    } else if (option == "-o") {
+      output = value;
+    } else if (option == "-b") {
+      binary = value;
+    } else if (option == "-c") {
+      std::istringstream list(value);
+      std::string column;
+      while (std::getline(list, column, ','))
+        selected.push_back(column);
+    } else {
+      return Usage();
+    }
+  }
+  if (argc % 2 != 0 || segment < 2 || chunk == 0)
+    return Usage();
+
+  ChSensorLogReader reader;
+  if (!reader.Open(input)) {
+    std::cerr << "Could not read the log " << input << std::endl;
+    return 1;
+  }
+  size_t width = reader.Get_Columns();
+  const std::vector<std::string> &names = reader.Get_Names();
+  std::vector<size_t> columns;
+  for (const std::string &column : selected) {
+    // A column is selected by its index or its name
+    size_t c = 0;
+    if (!Parse_Size(column, c)) {
+      for (c = 0; c < width && names[c] != column; ++c) {
+      }
+    }
+    if (c >= width) {
+      std::cerr << "The log has no column " << column << ", it has " << width << " columns:";
+      for (const std::string &name : names)
+        std::cerr << " " << name;
+      std::cerr << std::endl;
+      return 1;
+    }
+    columns.push_back(c);
+  }
+  if (columns.empty()) {
+    for (size_t c = 1; c < width; ++c)
+      columns.push_back(c);
+  }
+
+  std::ofstream converted;
+  if (!binary.empty()) {
+    converted.open(binary.c_str(), std::ios::out | std::ios::binary);
+    ChSensorLogReader::Write_BinaryHeader(converted, static_cast<uint32_t>(width));
+  }
+
+  std::vector<std::unique_ptr<ChSensorWelch>> estimators;
+  std::vector<double> rows;
+  size_t total = 0;
+  while (size_t count = reader.Read(rows, chunk)) {
+    if (estimators.empty()) {
+      // Sample rate from the time column of the first chunk
+      if (sample_rate <= 0. && count > 1)
+        sample_rate = (count - 1) / (rows[(count - 1) * width] - rows[0]);
+      if (!(sample_rate > 0.)) {
+        std::cerr << "Could not estimate the sample rate, use -r" << std::endl;
+        return 1;
+      }
+      for (size_t i = 0; i < columns.size(); ++i)
+        estimators.emplace_back(new ChSensorWelch(segment, sample_rate));
+    }
+    for (size_t i = 0; i < columns.size(); ++i)
+      estimators[i]->Add(rows.data() + columns[i], count, width);
+    if (converted.is_open())
+      converted.write(reinterpret_cast<const char *>(rows.data()), rows.size() * sizeof(double));
+    total += count;
+  }
+  if (estimators.empty() || estimators[0]->Get_Segments() == 0) {
+    std::cerr << "The log has fewer rows than a segment" << std::endl;
+    return 1;
+  }
+
+  ChSensorCsvWriter writer;
+  writer.Set_Precision(10);
+  if (!writer.Open(output)) {
+    std::cerr << "Could not write " << output << std::endl;
+    return 1;
+  }
+  writer.Write("Frequency");
+  for (size_t c : columns)
+    writer.Write(names[c]);
+  writer.End_Line();
+  std::vector<std::vector<double>> psd;
+  for (auto &estimator : estimators)
+    psd.push_back(estimator->Get_PSD());
+  for (size_t k = 0; k < estimators[0]->Get_Bins(); ++k) {
+    writer.Write(estimators[0]->Get_Frequency(k));
+    for (auto &channel : psd)
+      writer.Write(channel[k]);
+    writer.End_Line();
+  }
+  writer.Close();
+
+  std::cout << total << " rows at " << sample_rate << " Hz, " << estimators[0]->Get_Segments() << " segments of "
+            << estimators[0]->Get_Bins() * 2 - 2 << " samples";
+  if (reader.Get_Skipped() > 0)
+    std::cout << ", " << reader.Get_Skipped() << " malformed lines skipped";
+  std::cout << std::endl;
+  return 0;
+}